@@ -0,0 +1,219 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : benchmark of EEWL get, put, begin and fastFormat
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  This application measures by micros the duration of begin, get, put
+  and fastFormat of EEWL, over a matrix of data sizes and circular buffer
+  lengths, and prints the results to Serial, one CSV line per operation:
+    target,options,data_size,blk_num,op,runs,avg_us,max_us
+  so the output of different boards, compile options and library
+  versions can be compared as a performance regression baseline. The
+  begin_empty operation is begin on a formatted buffer, begin is done
+  after enough puts to fill the buffer. Buffers not fitting into the
+  EEPROM are skipped. Runs on AVR, ESP8266, ESP32, ESP32-C3 and RP2040.
+
+.warning
+  All EEPROM data from BUFFER_START is overwritten. On flash emulated
+  EEPROM, each put commits a flash sector: keep PUT_RUNS small.
+
+.- */
+
+#define BUFFER_START 0x10 // EEPROM address where buffers start
+#define PUT_RUNS 20       // number of timed puts per buffer
+#define GET_RUNS 100      // number of timed gets per buffer
+#define BEGIN_RUNS 5      // number of timed begins per buffer
+
+// EEPROM bytes usable by the benchmark
+#ifdef __AVR__
+  #define EEPROM_SIZE (E2END + 1)
+#else
+  #define EEPROM_SIZE 4096
+#endif
+
+#include "eewl.h"
+
+// benchmark data of N bytes
+template <int N> struct Payload {
+  uint8_t bytes[N];
+};
+
+const int blkNums[] = {2, 10, 50};
+
+// duration statistics of an operation
+struct Timing {
+  unsigned long total = 0;
+  unsigned long max = 0;
+  int runs = 0;
+
+  void add(unsigned long us) {
+    total += us;
+    if (us > max)
+      max = us;
+    runs++;
+  }
+};
+
+
+// target board name
+const char *target()
+{
+  #if defined(__AVR__)
+  return "avr";
+  #elif defined(ESP8266)
+  return "esp8266";
+  #elif defined(CONFIG_IDF_TARGET_ESP32C3)
+  return "esp32c3";
+  #elif defined(ESP32)
+  return "esp32";
+  #elif defined(ARDUINO_ARCH_RP2040)
+  return "rp2040";
+  #else
+  return "other";
+  #endif
+}
+
+
+// compile options affecting performance, separated by '+'
+void printOptions()
+{
+  const char *sep = "";
+  #ifdef EEWL_FAST_BEGIN
+  Serial.print(sep); Serial.print("fast_begin"); sep = "+";
+  #endif
+  #ifdef EEWL_DEFER_COMMIT
+  Serial.print(sep); Serial.print("defer_commit"); sep = "+";
+  #endif
+  #if defined(EEWL_CRC8)
+  Serial.print(sep); Serial.print("crc8"); sep = "+";
+  #elif defined(EEWL_CRC16)
+  Serial.print(sep); Serial.print("crc16"); sep = "+";
+  #elif defined(EEWL_FLETCHER16)
+  Serial.print(sep); Serial.print("fletcher16"); sep = "+";
+  #endif
+  #ifdef EEWL_STATS
+  Serial.print(sep); Serial.print("stats"); sep = "+";
+  #endif
+  if (!*sep)
+    Serial.print("none");
+}
+
+
+// print a CSV result line
+void report(int dataSize, int blkNum, const char *op, Timing &timing)
+{
+  Serial.print(target());
+  Serial.print(',');
+  printOptions();
+  Serial.print(',');
+  Serial.print(dataSize);
+  Serial.print(',');
+  Serial.print(blkNum);
+  Serial.print(',');
+  Serial.print(op);
+  Serial.print(',');
+  Serial.print(timing.runs);
+  Serial.print(',');
+  Serial.print(timing.runs ? timing.total / timing.runs : 0);
+  Serial.print(',');
+  Serial.println(timing.max);
+}
+
+
+// benchmark a buffer of blkNum blocks of N bytes data
+template <int N> void bench(int blkNum)
+{
+  if (EEWL::bufferSize<Payload<N> >(blkNum) > EEPROM_SIZE - BUFFER_START)
+    return;
+
+  Payload<N> data;
+  memset(data.bytes,0x5a,N);
+  EEWLBase<> eewl(EEWLType<Payload<N> >(),blkNum,BUFFER_START);
+  unsigned long start;
+
+  // format a buffer in use
+  Timing format;
+  eewl.begin();
+  eewl.put(data);
+  start = micros();
+  eewl.fastFormat();
+  format.add(micros() - start);
+  report(N,blkNum,"fastFormat",format);
+
+  // begin of an empty buffer
+  Timing beginEmpty;
+  for (int i = 0; i < BEGIN_RUNS; i++) {
+    start = micros();
+    eewl.begin();
+    beginEmpty.add(micros() - start);
+  }
+  report(N,blkNum,"begin_empty",beginEmpty);
+
+  // put, going around the whole buffer at least once
+  Timing put;
+  int putRuns = PUT_RUNS > blkNum ? PUT_RUNS : blkNum + 1;
+  for (int i = 0; i < putRuns; i++) {
+    data.bytes[i % N]++;
+    start = micros();
+    eewl.put(data);
+    put.add(micros() - start);
+    yield();
+  }
+  report(N,blkNum,"put",put);
+
+  // get
+  Timing get;
+  for (int i = 0; i < GET_RUNS; i++) {
+    start = micros();
+    eewl.get(data);
+    get.add(micros() - start);
+  }
+  report(N,blkNum,"get",get);
+
+  // begin of a buffer in use
+  Timing begin;
+  for (int i = 0; i < BEGIN_RUNS; i++) {
+    start = micros();
+    eewl.begin();
+    begin.add(micros() - start);
+  }
+  report(N,blkNum,"begin",begin);
+
+  eewl.fastFormat();
+}
+
+
+void setup()
+{
+  // initialize serial
+  Serial.begin(115200);
+  delay(2000);
+
+  // init EEPROM, reserving all of it, so the emulation has its full size
+  EEWLDefaultBackend::reserve(EEPROM_SIZE);
+  EEWLDefaultBackend::begin();
+
+  Serial.println("target,options,data_size,blk_num,op,runs,avg_us,max_us");
+  for (unsigned i = 0; i < sizeof(blkNums) / sizeof(blkNums[0]); i++) {
+    bench<4>(blkNums[i]);
+    bench<16>(blkNums[i]);
+    bench<64>(blkNums[i]);
+    bench<256>(blkNums[i]);
+  }
+  Serial.println("done");
+}
+
+
+void loop()
+{
+  delay(1000);
+}
+
+/**** END ****/
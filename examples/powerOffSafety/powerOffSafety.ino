@@ -15,17 +15,19 @@
   saved again into EEPROM to be preserved accross power cycles.
   A circular buffer len of 10 is defined. This extends the EEPROM life
   10 times, about 1 million of power cycles.
-  The application uses a version of EEWl where the set free of the old
-  data block is removed. This simulates a power off falling between
-  the new data write and the old data removal. In this way, it is tested
-  the capability of the begin method to recover from this anomaly.
+  After each put, the application restores the data marker of the old
+  data block, undoing its set free. This simulates a power off falling
+  between the new data write and the old data removal. In this way, it is
+  tested the capability of the begin method to recover from this anomaly.
+  A test of all the possible power off points on the host is available
+  in extras/faultinject.
 
 .- */
 
 #define BUFFER_LEN 10     // number of data blocks (1 blk = 1 ulong)
 #define BUFFER_START 0x10 // EEPROM address where buffer starts
 
-#include "eewl_powerOffSafety.h"
+#include "eewl.h"
 
 unsigned long powerCycles = 0;
 EEWL pC(powerCycles, BUFFER_LEN, BUFFER_START);
@@ -44,10 +46,20 @@ void setup()
   if (!pC.get(powerCycles))
     Serial.println("\nsetup: first time ever");
 
+  // save address and marker of the current data block
+  int old_blk_addr = pC.blk_addr;
+  int old_blk_mark = old_blk_addr ? pC.read(old_blk_addr) : 0xff;
+
   // increment power cycles counter and save it into EEPROM
   powerCycles++;
   pC.put(powerCycles);
 
+  // simulate a power off before the set free of the old data block
+  if (old_blk_addr) {
+    pC.write(old_blk_addr,old_blk_mark);
+    EEWL::commit();
+  }
+
   // display power cycles count
   Serial.print("\npower cycles = ");
   Serial.println(powerCycles);
@@ -0,0 +1,220 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : host benchmark and wear simulation
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  Desktop program running EEWL over a RAM backend with counted reads and
+  writes. For a matrix of data sizes and circular buffer
+  lengths it simulates a sequence of powered up begin and put calls and
+  reports:
+    - begin time and EEPROM reads per begin;
+    - put throughput and EEPROM reads/writes per put;
+    - per cell wear: number of programmed cells (writes changing the cell
+      value, as AVR update does) and the histogram of program counts
+      across the buffer cells.
+  The endurance multiplier is the number of puts divided by the program
+  count of the most worn cell.
+
+.build
+  c++ -O2 -std=c++11 -I../../src eewl_bench.cpp -o eewl_bench
+  Add any EEWL compile option to compare them, e.g. -DEEWL_FAST_BEGIN
+  or -DEEWL_CRC16. With -DEEWL_STATS, the EEWL counters of each
+  configuration are printed too.
+
+.usage
+  ./eewl_bench [puts per configuration, default 1000000]
+
+.- */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+
+/**** hooked RAM backend ****/
+
+static std::vector<uint32_t> cell_reads;
+static std::vector<uint32_t> cell_writes;
+static std::vector<uint32_t> cell_programs;
+
+#define EEWL_RAM
+#include "eewl.h"
+
+struct BenchRam: EEWLRam {
+
+  uint8_t read(int addr) {
+    cell_reads[addr]++;
+    return buffer[addr];
+  }
+
+  void write(int addr, uint8_t val) {
+    cell_writes[addr]++;
+    if (buffer[addr] != val) {
+      cell_programs[addr]++;
+      buffer[addr] = val;
+    }
+  }
+
+  void readBlock(int addr, uint8_t *data, int len) {
+    while (len--)
+      *data++ = read(addr++);
+  }
+
+  void writeBlock(int addr, const uint8_t *data, int len) {
+    while (len--)
+      write(addr++,*data++);
+  }
+
+};
+
+typedef EEWLBase<BenchRam> BenchEEWL;
+
+
+/**** benchmark ****/
+
+#define BUFFER_START 0x10
+#define HISTOGRAM_BINS 10
+
+template <int SIZE> struct Data {
+  uint8_t bytes[SIZE];
+};
+
+
+static uint64_t sum(const std::vector<uint32_t> &counts) {
+  uint64_t total = 0;
+  for (size_t i = 0; i < counts.size(); i++)
+    total += counts[i];
+  return total;
+}
+
+
+static void resetCounts(size_t size) {
+  cell_reads.assign(size,0);
+  cell_writes.assign(size,0);
+  cell_programs.assign(size,0);
+}
+
+
+template <int SIZE> void bench(int blk_num, long puts) {
+
+  typedef std::chrono::steady_clock clock;
+  Data<SIZE> data;
+  BenchEEWL eewl(data,blk_num,BUFFER_START);
+  memset(eewl.buffer,0xff,eewl.end_addr);
+  resetCounts(eewl.end_addr);
+  eewl.begin();
+
+  // puts, changing data at each one
+  clock::time_point t0 = clock::now();
+  for (long n = 0; n < puts; n++) {
+    memset(data.bytes,(int)(n & 0xff),SIZE);
+    data.bytes[0] = (uint8_t)(n >> 8);
+    eewl.put(data);
+  }
+  double put_ns =
+    std::chrono::duration<double,std::nano>(clock::now() - t0).count() / puts;
+  double put_reads = (double)sum(cell_reads) / puts;
+  double put_writes = (double)sum(cell_writes) / puts;
+  std::vector<uint32_t> programs = cell_programs;
+
+  // begins over the buffer left by puts
+  const int begins = 1000;
+  resetCounts(eewl.end_addr);
+  t0 = clock::now();
+  for (int n = 0; n < begins; n++)
+    eewl.begin();
+  double begin_ns =
+    std::chrono::duration<double,std::nano>(clock::now() - t0).count() / begins;
+  double begin_reads = (double)sum(cell_reads) / begins;
+
+  // wear of buffer cells
+  uint32_t max_programs = 0;
+  uint64_t total_programs = 0;
+  for (uint32_t addr = eewl.start_addr; addr < eewl.end_addr; addr++) {
+    total_programs += programs[addr];
+    if (programs[addr] > max_programs)
+      max_programs = programs[addr];
+  }
+  int cells = eewl.end_addr - eewl.start_addr;
+  printf("%5d %6d %10.1f %10.1f %11.1f %8.2f %9.0f %9.2f %8.2f\n",
+    SIZE,blk_num,begin_ns,begin_reads,put_ns,put_reads,put_writes,
+    (double)total_programs / cells,
+    max_programs ? (double)puts / max_programs : 0.0);
+
+  // histogram of cell program counts, bins from 0 to max count
+  printf("      histogram:");
+  uint32_t bins[HISTOGRAM_BINS] = {0};
+  for (uint32_t addr = eewl.start_addr; addr < eewl.end_addr; addr++) {
+    int bin = max_programs ?
+      (int)((uint64_t)programs[addr] * HISTOGRAM_BINS / (max_programs + 1)) : 0;
+    bins[bin]++;
+  }
+  for (int bin = 0; bin < HISTOGRAM_BINS; bin++)
+    printf(" %u",bins[bin]);
+  printf("  (max %u programs)\n",max_programs);
+
+  #ifdef EEWL_STATS
+  EEWLStats &stats = eewl.stats;
+  printf("      stats: %u puts, %u writes, %u skipped, put max %u us,"
+    " begin max %u us\n",stats.puts,stats.writes,stats.skipped,
+    stats.put_us_max,stats.begin_us_max);
+  #endif
+
+  free(eewl.buffer);
+
+}
+
+
+template <int SIZE> void benchSize(long puts) {
+
+  static const int blk_nums[] = {10, 100, 1000};
+  for (size_t i = 0; i < sizeof(blk_nums) / sizeof(blk_nums[0]); i++)
+    bench<SIZE>(blk_nums[i],puts);
+
+}
+
+
+int main(int argc, char **argv) {
+
+  long puts = argc > 1 ? atol(argv[1]) : 1000000;
+
+  printf("EEWL host benchmark, %ld puts per configuration, options:",puts);
+  #ifdef EEWL_FAST_BEGIN
+  printf(" EEWL_FAST_BEGIN");
+  #endif
+  #ifdef EEWL_CRC8
+  printf(" EEWL_CRC8");
+  #endif
+  #ifdef EEWL_CRC16
+  printf(" EEWL_CRC16");
+  #endif
+  #ifdef EEWL_FLETCHER16
+  printf(" EEWL_FLETCHER16");
+  #endif
+  #ifdef EEWL_STATS
+  printf(" EEWL_STATS");
+  #endif
+  printf("\n\n");
+  printf(" size blknum   begin_ns begin_reads     put_ns put_reads"
+    " put_writes prog/cell endurance\n");
+
+  benchSize<1>(puts);
+  benchSize<4>(puts);
+  benchSize<16>(puts);
+  benchSize<64>(puts);
+
+  return 0;
+
+}
+
+/**** end ****/
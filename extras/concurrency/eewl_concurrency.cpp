@@ -0,0 +1,144 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : host concurrency check of EEWL shared and background
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  Desktop program building EEWLShared and EEWLBackground over the RAM
+  backend, with host threads in place of tasks and cores. For each class,
+  two writer threads put data concurrently while a reader thread gets it.
+  Each data written has a check word equal to the complement of its
+  value, so a reader seeing a torn copy finds them different. At the end,
+  the saved data must be the last put of one of the writers and no write
+  must be pending.
+
+.build
+  c++ -O2 -std=c++17 -pthread -I../../src eewl_concurrency.cpp
+    -o eewl_concurrency
+  Add any EEWL compile option to check it, e.g. -DEEWL_FAST_BEGIN or
+  -DEEWL_STATS.
+
+.usage
+  ./eewl_concurrency [puts per writer, default 100000]
+
+.- */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#define EEWL_RAM
+#include "eewl.h"
+#include "eewl_shared.h"
+#include "eewl_background.h"
+
+
+/**** checks ****/
+
+#define BUFFER_START 0x10
+#define SECOND_BASE (1ul << 30)
+
+struct Data {
+  uint32_t value;
+  uint32_t pad[6];
+  uint32_t check;
+};
+
+
+// concurrent puts and gets on object s, put by P. Returns the failures.
+template <class S, class P> long check(const char *name, S &s, P put,
+  long puts) {
+
+  memset(s.eewl.buffer,0xff,s.eewl.end_addr);
+  s.begin();
+
+  std::atomic<bool> stop(false);
+  long reads = 0;
+  long bad = 0;
+  std::thread reader([&] {
+    Data data;
+    while (!stop)
+      if (s.get(data)) {
+        reads++;
+        if (data.value != ~data.check)
+          bad++;
+      }
+  });
+
+  auto writer = [&](uint32_t base) {
+    for (long n = 0; n < puts; n++) {
+      Data data = Data();
+      data.value = base + n;
+      data.check = ~data.value;
+      put(s,data);
+    }
+  };
+  std::thread first(writer,1);
+  std::thread second(writer,SECOND_BASE);
+  first.join();
+  second.join();
+  s.flushBlocking();
+  stop = true;
+  reader.join();
+
+  // saved data must be the last put of a writer
+  Data data;
+  bool last = s.get(data) && (data.value == (uint32_t)puts
+    || data.value == SECOND_BASE + puts - 1);
+  long failures = bad + !last + s.busy();
+  printf("%s: %ld reads, %ld torn, last data %s, %s\n",name,reads,bad,
+    last ? "right" : "wrong",s.busy() ? "busy" : "idle");
+  return failures;
+
+}
+
+
+// shared object, with the flush of the background one
+struct Shared: EEWLShared<Data> {
+
+  Shared(void): EEWLShared<Data>(8,BUFFER_START) {}
+
+  void flushBlocking(void) {}
+
+};
+
+static Shared shared;
+static EEWLBackground<Data> background(8,BUFFER_START);
+
+
+int main(int argc, char **argv) {
+
+  long puts = argc > 1 ? atol(argv[1]) : 100000;
+
+  printf("EEWL host concurrency check, %ld puts per writer, options:",puts);
+  #ifdef EEWL_FAST_BEGIN
+  printf(" EEWL_FAST_BEGIN");
+  #endif
+  #ifdef EEWL_STATS
+  printf(" EEWL_STATS");
+  #endif
+  printf("\n");
+
+  long failures = 0;
+  failures += check("shared",shared,
+    [](Shared &s, const Data &data) { s.put(data); },puts);
+  failures += check("background",background,
+    [](EEWLBackground<Data> &s, const Data &data) { s.put(data); },puts);
+
+  // the background worker thread never ends: exit without destructors
+  printf("%ld failures\n",failures);
+  fflush(stdout);
+  _Exit(failures ? 1 : 0);
+
+}
+
+/**** end ****/
@@ -0,0 +1,415 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : host power off fault injection
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  Desktop program checking the power off safety of EEWL over a RAM
+  backend with power off injection on writes. For every data size and circular
+  buffer length of the given ranges, it runs a sequence of puts, more
+  than twice the buffer length, to cover wrap arounds. Before each put,
+  the EEPROM image is saved, then the put is restarted from the saved
+  image and aborted, by a power off, at every possible write count.
+  After each power off, begin is run, itself aborted at every possible
+  write count of its recovery, and the recovered data is checked: it
+  must be either the old data or the new one, and a completed put must
+  always give the new one. Then a new put must work normally.
+
+  The same check is done on EEWLDelta member patches and snapshots, and
+  on EEWLPacked variable length records.
+
+.power_off_model
+  By default, a power off drops the aborted write. With option -t, the
+  aborted write leaves a torn cell, as an interrupted AVR EEPROM write:
+  some bits already erased to 1, or some bits already programmed to 0.
+
+.build
+  c++ -O2 -std=c++11 -I../../src eewl_faultinject.cpp -o eewl_faultinject
+  Add any EEWL compile option to check it, e.g. -DEEWL_FAST_BEGIN or
+  -DEEWL_CRC16.
+
+.usage
+  ./eewl_faultinject [-t] [max data size, default 16]
+    [max buffer length, default 40]
+
+.- */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+
+/**** hooked RAM backend with power off injection ****/
+
+struct PowerOff {};
+
+static long write_budget = -1;    // writes allowed before power off, -1 off
+static bool torn_writes = false;
+static uint32_t torn_seed = 1;
+
+static inline uint32_t tornRandom(void) {
+  torn_seed = torn_seed * 1103515245 + 12345;
+  return torn_seed >> 16;
+}
+
+#define EEWL_RAM
+#include "eewl.h"
+#include "eewl_delta.h"
+#include "eewl_packed.h"
+
+struct FaultRam: EEWLRam {
+
+  void write(int addr, uint8_t val) {
+    if (write_budget == 0) {
+      if (torn_writes) {
+        uint8_t mask = tornRandom();
+        if (tornRandom() & 1)
+          buffer[addr] |= mask;                 // erase partially done
+        else
+          buffer[addr] = 0xff & ~(~val & mask); // program partially done
+      }
+      throw PowerOff();
+    }
+    if (write_budget > 0)
+      write_budget--;
+    buffer[addr] = val;
+  }
+
+  void writeBlock(int addr, const uint8_t *data, int len) {
+    while (len--)
+      write(addr++,*data++);
+  }
+
+};
+
+typedef EEWLBase<FaultRam> FaultEEWL;
+
+#define BUFFER_START 0x10
+
+
+/**** checks ****/
+
+static long checks = 0;
+static long failures = 0;
+
+template <int SIZE> struct Data {
+  uint8_t bytes[SIZE];
+};
+
+
+// value of n-th put
+template <int SIZE> static void fill(Data<SIZE> &data, uint32_t n) {
+  for (int i = 0; i < SIZE; i++)
+    data.bytes[i] = (uint8_t)(n * 31 + i);
+  data.bytes[0] = (uint8_t)n;
+}
+
+
+static void fail(const char *what, int size, int blk_num, int round, long k) {
+  failures++;
+  if (failures <= 20)
+    printf("FAIL %s: size %d blk_num %d put %d power off at write %ld\n",
+      what,size,blk_num,round,k);
+}
+
+
+// begin with repeated power offs during its recovery, aborted after 0, 1,
+// 2 ... writes, until a begin completes.
+static void beginWithFaults(FaultEEWL &eewl) {
+  for (long k = 0;; k++) {
+    write_budget = k;
+    try {
+      eewl.begin();
+      write_budget = -1;
+      return;
+    }
+    catch (PowerOff &) {}
+    write_budget = -1;
+  }
+}
+
+
+template <int SIZE> void checkEEWL(int blk_num) {
+
+  typedef Data<SIZE> T;
+  T data;
+  FaultEEWL eewl(data,blk_num,BUFFER_START);
+  memset(eewl.buffer,0xff,eewl.end_addr);
+  eewl.begin();
+
+  int rounds = 2 * blk_num + 3;
+  for (int round = 0; round < rounds; round++) {
+
+    std::vector<uint8_t> image(eewl.buffer,eewl.buffer + eewl.end_addr);
+    FaultEEWL saved = eewl;
+    T old_data, new_data, got;
+    fill(old_data,round - 1);
+    fill(new_data,round);
+
+    for (long k = 0;; k++) {
+
+      // put aborted after k writes
+      memcpy(eewl.buffer,image.data(),image.size());
+      eewl = saved;
+      write_budget = k;
+      bool done = true;
+      try {
+        T put_data = new_data;
+        eewl.put(put_data);
+      }
+      catch (PowerOff &) {
+        done = false;
+      }
+      write_budget = -1;
+
+      // power up: begin with faults, then begin again
+      FaultEEWL up = eewl;
+      beginWithFaults(up);
+      up.begin();
+      checks++;
+      int ok = up.get(got);
+      bool is_new = ok && !memcmp(&got,&new_data,sizeof(T));
+      bool is_old = round ? ok && !memcmp(&got,&old_data,sizeof(T)) : !ok;
+      if (done ? !is_new : !(is_new || is_old))
+        fail(done ? "completed put lost" : "wrong data recovered",
+          SIZE,blk_num,round,k);
+
+      // a put after recovery must work
+      if (!done) {
+        T next;
+        fill(next,0xabcd);
+        up.put(next);
+        up.begin();
+        if (!up.get(got) || memcmp(&got,&next,sizeof(T)))
+          fail("put after recovery",SIZE,blk_num,round,k);
+      }
+      else
+        break;
+    }
+
+    // do the put for real
+    memcpy(eewl.buffer,image.data(),image.size());
+    eewl = saved;
+    eewl.put(new_data);
+    eewl.begin();
+  }
+
+}
+
+
+struct Config {
+  uint32_t counter;
+  uint8_t bytes[11];
+  uint16_t word;
+};
+
+typedef EEWLDelta<Config,4,FaultRam> FaultDelta;
+
+
+void checkDelta(int blk_num, int patch_num) {
+
+  Config data;
+  memset(&data,0,sizeof(data));
+  FaultDelta delta(data,blk_num,patch_num,BUFFER_START);
+  memset(delta.snapshot.buffer,0xff,delta.end_addr);
+  delta.begin();
+  Config current = data;
+
+  for (int round = 0; round < 3 * (patch_num + 1) * blk_num; round++) {
+
+    std::vector<uint8_t> image(delta.snapshot.buffer,
+      delta.snapshot.buffer + delta.end_addr);
+    FaultDelta saved = delta;
+    Config next = current;
+    int kind = round % 5;
+    if (kind == 4)
+      memset(next.bytes,round,sizeof(next.bytes));
+    else if (kind == 3)
+      next.word = round;
+    else
+      next.counter = round;
+
+    for (long k = 0;; k++) {
+
+      memcpy(delta.snapshot.buffer,image.data(),image.size());
+      delta = saved;
+      data = current;
+      write_budget = k;
+      bool done = true;
+      try {
+        if (kind == 4) {
+          data = next;
+          delta.put(data);
+        }
+        else if (kind == 3)
+          delta.putField(&Config::word,next.word);
+        else
+          delta.putField(&Config::counter,next.counter);
+      }
+      catch (PowerOff &) {
+        done = false;
+      }
+      write_budget = -1;
+
+      FaultDelta up = delta;
+      Config got;
+      up.ram_data = &got;
+      up.begin();
+      checks++;
+      int ok = up.get(got);
+      bool is_new = ok && !memcmp(&got,&next,sizeof(got));
+      bool is_old = ok ? !memcmp(&got,&current,sizeof(got)) : round == 0;
+      if (done ? !is_new : !(is_new || is_old))
+        fail("delta",sizeof(Config),blk_num,round,k);
+      if (done)
+        break;
+    }
+
+    current = next;
+  }
+
+}
+
+
+typedef Data<24> Sparse;
+typedef EEWLPacked<Sparse,FaultRam> FaultPacked;
+
+
+// value of n-th put, with a number of zero bytes changing with n, so
+// records have different lengths.
+static void fillSparse(Sparse &data, uint32_t n) {
+  memset(&data,0,sizeof(data));
+  for (int i = 0; i < (int)(n * 7 % sizeof(data)); i++)
+    data.bytes[i] = (uint8_t)(n * 31 + i) | 1;
+  data.bytes[sizeof(data) - 1] = (uint8_t)n;
+}
+
+
+void checkPacked(int extra_size) {
+
+  FaultPacked packed(3 * FaultPacked::maxRecordSize() + extra_size,
+    BUFFER_START);
+  memset(packed.anchor.buffer,0xff,packed.end_addr);
+  packed.begin();
+
+  for (int round = 0; round < 40; round++) {
+
+    std::vector<uint8_t> image(packed.anchor.buffer,
+      packed.anchor.buffer + packed.end_addr);
+    FaultPacked saved = packed;
+    Sparse old_data, new_data, got;
+    fillSparse(old_data,round - 1);
+    fillSparse(new_data,round);
+
+    for (long k = 0;; k++) {
+
+      memcpy(packed.anchor.buffer,image.data(),image.size());
+      packed = saved;
+      write_budget = k;
+      bool done = true;
+      try {
+        packed.put(new_data);
+      }
+      catch (PowerOff &) {
+        done = false;
+      }
+      write_budget = -1;
+
+      FaultPacked up = packed;
+      up.begin();
+      checks++;
+      int ok = up.get(got);
+      bool is_new = ok && !memcmp(&got,&new_data,sizeof(got));
+      bool is_old = round ? ok && !memcmp(&got,&old_data,sizeof(got)) : !ok;
+      if (done ? !is_new : !(is_new || is_old))
+        fail(done ? "packed completed put lost" : "packed wrong data",
+          sizeof(Sparse),extra_size,round,k);
+
+      // puts of a short and of a long record after recovery must work
+      if (!done) {
+        for (int n = 0; n < 2; n++) {
+          Sparse next;
+          fillSparse(next,n ? 3 : 0);
+          up.put(next);
+          up.begin();
+          if (!up.get(got) || memcmp(&got,&next,sizeof(got)))
+            fail("packed put after recovery",sizeof(Sparse),extra_size,
+              round,k);
+        }
+      }
+      else
+        break;
+    }
+
+    memcpy(packed.anchor.buffer,image.data(),image.size());
+    packed = saved;
+    packed.put(new_data);
+    packed.begin();
+  }
+
+}
+
+
+template <int SIZE> void checkSizes(int max_size, int max_blk_num) {
+
+  if (SIZE > max_size)
+    return;
+  for (int blk_num = 2; blk_num <= max_blk_num; blk_num++)
+    checkEEWL<SIZE>(blk_num);
+  checkSizes<SIZE + 1>(max_size,max_blk_num);
+
+}
+
+template <> void checkSizes<65>(int, int) {}
+
+
+int main(int argc, char **argv) {
+
+  int arg = 1;
+  if (arg < argc && !strcmp(argv[arg],"-t")) {
+    torn_writes = true;
+    arg++;
+  }
+  int max_size = arg < argc ? atoi(argv[arg++]) : 16;
+  int max_blk_num = arg < argc ? atoi(argv[arg++]) : 40;
+  if (max_size > 64)
+    max_size = 64;
+
+  printf("EEWL power off fault injection, data size 1..%d, blk_num 2..%d,"
+    " %s writes, options:",max_size,max_blk_num,
+    torn_writes ? "torn" : "dropped");
+  #ifdef EEWL_FAST_BEGIN
+  printf(" EEWL_FAST_BEGIN");
+  #endif
+  #ifdef EEWL_CRC8
+  printf(" EEWL_CRC8");
+  #endif
+  #ifdef EEWL_CRC16
+  printf(" EEWL_CRC16");
+  #endif
+  #ifdef EEWL_FLETCHER16
+  printf(" EEWL_FLETCHER16");
+  #endif
+  printf("\n");
+
+  checkSizes<1>(max_size,max_blk_num);
+  for (int blk_num = 2; blk_num <= 5; blk_num++)
+    for (int patch_num = 1; patch_num <= 4; patch_num++)
+      checkDelta(blk_num,patch_num);
+  for (int extra_size = 0; extra_size < 8; extra_size++)
+    checkPacked(extra_size);
+
+  printf("%ld power off checks, %ld failures\n",checks,failures);
+  return failures ? 1 : 0;
+
+}
+
+/**** end ****/
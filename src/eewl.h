@@ -20,7 +20,63 @@
 
 .compile_options
   1. debugging printout methods, to include them define symbol EEWL_DEBUG.
-  2. use RAM instead of EEPROM, to activate define symbol EEWL_RAM.
+  2. use RAM instead of EEPROM as default storage backend, to activate
+     define symbol EEWL_RAM.
+  3. on flash emulated EEPROM (ESP8266, ESP32, RP2040), defer the commit
+     of put and fastFormat until EEWL::commitAll is called, to activate
+     define symbol EEWL_DEFER_COMMIT.
+  4. sequence mode buffer layout, allowing begin to locate the current data
+     by a binary search, to activate define symbol EEWL_FAST_BEGIN.
+  5. data block checksum, checked by begin, to activate define one of
+     symbols EEWL_CRC8, EEWL_CRC16, EEWL_FLETCHER16.
+  6. on AVR, background put driven by the EEPROM ready interrupt, to
+     activate define symbol EEWL_ASYNC (in one source file only, since it
+     defines the interrupt handler). EEWL_ASYNC_SIZE sets the maximum data
+     size, default 32 bytes.
+  7. wear and performance counters, per EEWL object and total over all
+     objects (see EEWLStats), to activate define symbol EEWL_STATS.
+
+.default_mode
+  The data block marker rotates over 8 values with one zero bit, in the
+  order 0xfe, 0xfd, ... 0x7f, changing at each put, and the old data block
+  is set free. begin compares the markers to find the newest data block,
+  so after a put interrupted by power off, or any other layout with more
+  than one block in use, it keeps the newest block with a right checksum,
+  and sets free the others.
+
+.sequence_mode
+  In sequence mode, the data block marker is the same for all blocks
+  written during the same pass over the circular buffer and changes at
+  each wrap around. Old data blocks are not set free, so the buffer is
+  made of a run of blocks of the current pass followed by the blocks of
+  the previous pass (or by free blocks, during the first pass). The last
+  block of the current pass is the current data and it is found by a
+  binary search. Before writing, the new block is set free, so a power
+  off during the write leaves the current data untouched. The layout is
+  checked by a linear scan when the binary search result is not
+  consistent.
+
+.storage_backends
+  EEWL accesses the storage by a backend class, given as template argument
+  of EEWLBase. EEWL is EEWLBase over the default backend of the target:
+  EEWLEeprom (AVR EEPROM), EEWLFlashEeprom (ESP8266, ESP32, RP2040 flash
+  emulated EEPROM) or EEWLRam (RAM buffer, with EEWL_RAM). A backend has
+  the following members, static or not:
+    typedef ... addr_t;             unsigned type of addresses and sizes
+    uint8_t read(addr_t addr);
+    void write(addr_t addr, uint8_t val);
+    void readBlock(addr_t addr, uint8_t *data, int len);
+    void writeBlock(addr_t addr, const uint8_t *data, int len);
+    static void commit(void);       write changes to the storage device
+    void reserve(addr_t end_addr);  storage up to end_addr is used
+    void begin(void);               init storage, called by EEWL begin
+    const uint8_t *dataPtr(addr_t addr);  RAM address of addr, 0 if none
+    static const bool buffered;     true if changes need a commit
+    static const int page_size;     write page size, 1 if none
+  A backend without member vars adds nothing to the size of EEWL objects.
+  The backend page size is the default PAGE_SIZE template argument of
+  EEWLBase: when larger than 1, blocks are padded and aligned so that each
+  block, marker included, is within one page.
 
 .- */
 
@@ -28,175 +84,1049 @@
 #define EEWL_H
 
 
-/**** macros ****/
+/**** storage backends ****/
+
+#if !defined(EEWL_RAM) && !defined(__AVR__) && !defined(ESP8266) \
+  && !defined(ESP32) && !defined(TARGET_RP2040)
+  #error ERROR: unsupported architecture
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef EEWL_RAM
+  #include <EEPROM.h>
+  #if defined(ESP8266) || defined(ESP32) || defined(TARGET_RP2040)
+    #define EEWL_FLASH_EMU
+  #endif
+#elif defined(EEWL_STATS)
+  #include <chrono>
+#endif
+
+
+// RAM buffer, for testing pourposes. The buffer is extended at each
+// reserve to cover the reserved addresses.
+struct EEWLRam {
+
+  typedef uint32_t addr_t;
+  static const bool buffered = false;
+  static const int page_size = 1;
+
+  uint8_t *buffer = 0;
+
+  uint8_t read(addr_t addr) { return buffer[addr]; }
+
+  void write(addr_t addr, uint8_t val) { buffer[addr] = val; }
+
+  void readBlock(addr_t addr, uint8_t *data, int len) {
+    memcpy(data,buffer + addr,len);
+  }
+
+  void writeBlock(addr_t addr, const uint8_t *data, int len) {
+    memcpy(buffer + addr,data,len);
+  }
+
+  static void commit(void) {}
+
+  void reserve(addr_t end_addr) {
+    buffer = (uint8_t *)realloc(buffer,end_addr);
+  }
+
+  static void begin(void) {}
+
+  const uint8_t *dataPtr(addr_t addr) { return buffer + addr; }
+
+};
+
+
+#if !defined(EEWL_RAM) && defined(__AVR__)
+
+// AVR EEPROM, byte writes are skipped when the byte is unchanged
+struct EEWLEeprom {
+
+  typedef uint16_t addr_t;
+  static const bool buffered = false;
+  static const int page_size = 1;
+
+  static uint8_t read(addr_t addr) { return EEPROM[addr]; }
+
+  static void write(addr_t addr, uint8_t val) { EEPROM[addr].update(val); }
+
+  static void readBlock(addr_t addr, uint8_t *data, int len) {
+    while (len--)
+      *data++ = EEPROM[addr++];
+  }
+
+  static void writeBlock(addr_t addr, const uint8_t *data, int len) {
+    while (len--)
+      EEPROM[addr++].update(*data++);
+  }
+
+  static void commit(void) {}
+
+  static void reserve(addr_t end_addr) { (void)end_addr; }
+
+  static void begin(void) {}
+
+  static const uint8_t *dataPtr(addr_t addr) { (void)addr; return 0; }
+
+};
+
+typedef EEWLEeprom EEWLDefaultBackend;
+
+#endif
+
+
+#ifdef EEWL_FLASH_EMU
+
+// flash emulated EEPROM: reads and writes go to the emulation RAM buffer,
+// commit writes it to flash. The emulation is sized to the highest
+// reserved address, so RAM buffer and commit cost are not larger than
+// needed.
+struct EEWLFlashEeprom {
+
+  typedef uint32_t addr_t;
+  static const bool buffered = true;
+  static const int page_size = 1;
+
+  static inline addr_t highest_end_addr = 0;
+  static inline bool begin_done = false;
+
+  static uint8_t read(addr_t addr) {
+    #ifdef ESP32
+    return EEPROM.read(addr);
+    #else
+    return EEPROM.getConstDataPtr()[addr];
+    #endif
+  }
+
+  static void write(addr_t addr, uint8_t val) { EEPROM.write(addr,val); }
+
+  static void readBlock(addr_t addr, uint8_t *data, int len) {
+    #ifdef ESP32
+    EEPROM.readBytes(addr,data,len);
+    #else
+    memcpy(data,EEPROM.getConstDataPtr() + addr,len);
+    #endif
+  }
+
+  static void writeBlock(addr_t addr, const uint8_t *data, int len) {
+    #ifdef ESP32
+    EEPROM.writeBytes(addr,data,len);
+    #else
+    memcpy(EEPROM.getDataPtr() + addr,data,len);
+    #endif
+  }
+
+  static void commit(void) { EEPROM.commit(); }
+
+  static void reserve(addr_t end_addr) {
+    if (highest_end_addr < end_addr)
+      highest_end_addr = end_addr;
+  }
+
+
+  // init EEPROM emulation with the size of reserved addresses, only the
+  // first call is effective. On ESP32, a failed init is retried a few
+  // times. Each call checks that the emulation covers all the reserved
+  // addresses, an object constructed after the first call may exceed it.
+  static void begin(void) {
+
+    if (!begin_done) {
+      #if defined(ESP8266) || defined(TARGET_RP2040)
+      EEPROM.begin(highest_end_addr);
+      #elif defined(ESP32)
+      for (int tries = 1; !EEPROM.begin(highest_end_addr); tries++) {
+        if (tries == 10)
+          halt("ERROR: EEPROM init failure");
+        delay(10);
+      }
+      #endif
+      begin_done = true;
+    }
+    if (EEPROM.length() < highest_end_addr)
+      halt("ERROR: EEPROM reserved after init");
+
+  }
+
+
+  static void halt(const char *msg) {
+    Serial.println(msg);
+    while(true) delay(1000);
+  }
+
+
+  // ESP32 has no const accessor: getDataPtr marks the RAM buffer as
+  // changed, harmless since EEWL commits only after its writes
+  static const uint8_t *dataPtr(addr_t addr) {
+    #ifdef ESP32
+    return EEPROM.getDataPtr() + addr;
+    #else
+    return EEPROM.getConstDataPtr() + addr;
+    #endif
+  }
+
+};
+
+typedef EEWLFlashEeprom EEWLDefaultBackend;
+
+#endif
+
 
 #ifdef EEWL_RAM
-  #define EE_WRITE( addr , val ) (buffer[(int)( addr )] = val)
-  #define EE_READ( addr ) (buffer[(int)( addr )])
-#else
+typedef EEWLRam EEWLDefaultBackend;
+#endif
+
+
+/**** checksum ****/
+
+// data block checksum, computed incrementally over data bytes. It is
+// saved after data, low byte first. With no checksum, size is 0 and all
+// checksum code is optimized away.
+#if defined(EEWL_CRC8) || defined(EEWL_CRC16)
   #ifdef __AVR__
-    #define EE_WRITE( addr , val ) (EEPROM[ (int)( addr )  ].update( val ))
-  #elif defined(ESP8266) || defined(ESP32) || defined(TARGET_RP2040)
-    #define EE_WRITE( addr , val ) (EEPROM.write((int)( addr ),( val )))
-  #else
-    #error ERROR: unsupported architecture
+    #include <util/crc16.h>
   #endif
-  #ifdef ESP32
-    #define EE_READ( addr ) (EEPROM.read((int)( addr )))
+#endif
+
+struct EEWLChecksum {
+
+  #if defined(EEWL_CRC8)
+
+  // CRC-8, polynomial 0x07, same of avr-libc _crc8_ccitt_update
+  static const int size = 1;
+  uint8_t sum = 0;
+
+  void add(uint8_t data) {
+    #ifdef __AVR__
+    sum = _crc8_ccitt_update(sum,data);
+    #else
+    static const uint8_t table[16] = {
+      0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15,
+      0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d};
+    sum ^= data;
+    sum = (sum << 4) ^ table[sum >> 4];
+    sum = (sum << 4) ^ table[sum >> 4];
+    #endif
+  }
+
+  #elif defined(EEWL_CRC16)
+
+  // CRC-16 CCITT, same of avr-libc _crc_ccitt_update
+  static const int size = 2;
+  uint16_t sum = 0xffff;
+
+  void add(uint8_t data) {
+    #ifdef __AVR__
+    sum = _crc_ccitt_update(sum,data);
+    #else
+    data ^= sum & 0xff;
+    data ^= data << 4;
+    sum = ((((uint16_t)data << 8) | (sum >> 8)) ^ (uint8_t)(data >> 4)
+      ^ ((uint16_t)data << 3));
+    #endif
+  }
+
+  #elif defined(EEWL_FLETCHER16)
+
+  // Fletcher-16, modulo 255 sums
+  static const int size = 2;
+  uint8_t sum1 = 0;
+  uint8_t sum2 = 0;
+  uint16_t sum = 0;
+
+  void add(uint8_t data) {
+    uint16_t s = sum1 + data;
+    sum1 = s >= 255 ? s - 255 : s;
+    s = sum2 + sum1;
+    sum2 = s >= 255 ? s - 255 : s;
+    sum = (sum2 << 8) | sum1;
+  }
+
   #else
-    #define EE_READ( addr ) (EEPROM[ (int)( addr ) ])
+
+  // no checksum
+  static const int size = 0;
+  uint8_t sum = 0;
+
+  void add(uint8_t data) { (void)data; }
+
   #endif
-  #include <EEPROM.h>
-#endif
+
+  void add(const uint8_t *ptr, int len) {
+    while (len--)
+      add(*ptr++);
+  }
+
+};
 
 
 /**** class ****/
 
-struct EEWL {
+// data type tag, to build an EEWL object without an instance of data
+template <typename T> struct EEWLType {};
+
+
+// deferred commits state, shared by all EEWL objects on backend B,
+// whatever their page size and geometry
+template <class B> struct EEWLCommitState {
+
+  static int batchDepth;
+  static bool commitPending;
+
+};
+
+template <class B> int EEWLCommitState<B>::batchDepth = 0;
+template <class B> bool EEWLCommitState<B>::commitPending = false;
+
+
+// put sequence state, used by writers that do a put step by step
+template <typename A> struct EEWLPutState {
+
+  A new_blk_addr;
+  A old_blk_addr;
+  int blk_mark;
+  const uint8_t *data;
+  int data_size;
+  int step;
+  EEWLChecksum chk;
+
+};
+
+
+// wear and performance counters. Writes are the bytes written to the
+// storage by EEWL, skipped are the written bytes that were already equal
+// to the stored ones (not programmed by backends that skip them). Commits
+// are counted in the total only, since they are shared by all objects.
+// Durations are in microseconds, from micros or, with EEWL_RAM, from the
+// host steady clock.
+struct EEWLStats {
+
+  uint32_t puts;
+  uint32_t writes;
+  uint32_t skipped;
+  uint32_t commits;
+  uint32_t formats;
+  uint32_t recoveries;
+  uint32_t begin_us;
+  uint32_t begin_us_max;
+  uint32_t put_us;
+  uint32_t put_us_max;
+
+};
+
+
+#ifdef EEWL_STATS
+
+// counters total over all EEWL objects (a template allows static members
+// defined in the header).
+template <int N = 0> struct EEWLStatsTotal {
+
+  static EEWLStats stats;
+
+};
+
+template <int N> EEWLStats EEWLStatsTotal<N>::stats;
+
+#endif
+
+
+#ifdef EEWL_ASYNC
+
+#if !defined(__AVR__) || defined(EEWL_RAM)
+  #error ERROR: EEWL_ASYNC requires AVR EEPROM
+#endif
+
+#include <avr/interrupt.h>
+
+#ifndef EEWL_ASYNC_SIZE
+  #define EEWL_ASYNC_SIZE 32
+#endif
+
+// background put state, shared by all EEWL objects (a template allows
+// static members defined in the header). The EEWL object is serviced by
+// the static member function of its own type.
+template <int N = 0> struct EEWLAsyncState {
+
+  static void *eewl;
+  static void (*service)(void);
+  static EEWLPutState<EEWLEeprom::addr_t> state;
+  static uint8_t buffer[EEWL_ASYNC_SIZE];
+  static void (*done)(void);
+  static volatile bool busy;
+
+};
+
+template <int N> void *EEWLAsyncState<N>::eewl;
+template <int N> void (*EEWLAsyncState<N>::service)(void);
+template <int N> EEWLPutState<EEWLEeprom::addr_t> EEWLAsyncState<N>::state;
+template <int N> uint8_t EEWLAsyncState<N>::buffer[EEWL_ASYNC_SIZE];
+template <int N> void (*EEWLAsyncState<N>::done)(void);
+template <int N> volatile bool EEWLAsyncState<N>::busy;
+
+#endif
+
+
+// compile time boolean, to select code by backend properties
+template <bool V> struct EEWLBool {};
+
+
+// buffer layout sizes for a given page size
+template <int PAGE_SIZE> struct EEWLLayout {
+
+  // size in bytes of a data block holding data of type T, padded when
+  // the page size is more than 1 byte.
+  template <typename T> static constexpr int blockSize(void) {
+    return alignSize(sizeof(T) + 1 + EEWLChecksum::size);
+  }
+
+
+  // size in bytes of a circular buffer of blk_num blocks of type T
+  template <typename T> static constexpr int bufferSize(int blk_num_) {
+    return blk_num_ * blockSize<T>();
+  }
+
+
+  // page aligned layout: a block size not larger than a page is rounded
+  // up to a divisor of the page size, so blocks tile pages, a larger one
+  // is rounded up to a multiple of the page size. Buffer starts at a page
+  // boundary, so no block crosses more page boundaries than needed.
+  static constexpr int alignSize(int size) {
+    return PAGE_SIZE <= 1 ? size
+      : size > PAGE_SIZE ? (size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE
+      : PAGE_SIZE % size ? alignSize(size + 1) : size;
+  }
+
+
+  // start address rounded up to a page boundary
+  static constexpr int alignAddr(int addr) {
+    return PAGE_SIZE <= 1 ? addr
+      : (addr + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+  }
+
+};
+
+
+// buffer geometry set at run time by the EEWL constructor
+template <typename A, int PAGE_SIZE> struct EEWLGeometry:
+  EEWLLayout<PAGE_SIZE> {
+
+  typedef EEWLLayout<PAGE_SIZE> layout;
+
+  A blk_num;
+  A blk_size;
+  A data_size;
+  A start_addr;
+  A end_addr;
+
+  template <typename T> void setGeometry(A blk_num_, A start_addr_) {
+    setGeometry(sizeof(T),blk_num_,start_addr_);
+  }
+
+
+  // geometry of blocks holding data_size_ bytes
+  void setGeometry(A data_size_, A blk_num_, A start_addr_) {
+    blk_size = layout::alignSize(data_size_ + 1 + EEWLChecksum::size);
+    data_size = data_size_;
+    blk_num = blk_num_;
+    start_addr = layout::alignAddr(start_addr_);
+    end_addr = start_addr + blk_num * blk_size;
+  }
+
+};
+
+
+// buffer geometry fixed at compile time: no RAM is used and address
+// computations are folded into constants.
+template <typename T, unsigned long BLK_NUM, unsigned long START_ADDR,
+  typename A, int PAGE_SIZE> struct EEWLStaticGeometry: EEWLLayout<PAGE_SIZE> {
+
+  typedef EEWLLayout<PAGE_SIZE> layout;
+
+  static_assert(START_ADDR != 0, "EEWL start address 0 not allowed");
+  static_assert(layout::alignAddr(START_ADDR) == START_ADDR,
+    "EEWL static start address not aligned to the backend page");
+  static_assert(START_ADDR + BLK_NUM * layout::template blockSize<T>()
+    <= (A)~0, "EEWL buffer beyond backend address range");
+
+  static const A blk_num = BLK_NUM;
+  static const A blk_size = layout::template blockSize<T>();
+  static const A data_size = sizeof(T);
+  static const A start_addr = START_ADDR;
+  static const A end_addr = start_addr + BLK_NUM * blk_size;
+
+};
+
+
+template <class B = EEWLDefaultBackend, int PAGE_SIZE = B::page_size,
+  class G = EEWLGeometry<typename B::addr_t,PAGE_SIZE> >
+struct EEWLBase: B, G {
+
+  typedef typename B::addr_t addr_t;
+  typedef EEWLPutState<addr_t> PutState;
+
+  // buffer geometry
+  using G::blk_num;
+  using G::blk_size;
+  using G::data_size;
+  using G::start_addr;
+  using G::end_addr;
 
   // control vars
-  int blk_num;
-  int blk_size;
-  int blk_addr;
+  addr_t blk_addr;
   int blk_mark = 0xfe;
-  int start_addr;
-  int end_addr;
 
-  #if (defined(ESP8266) || defined(ESP32)) || defined(TARGET_RP2040) && !defined(EEWL_RAM)
-  static inline int highest_end_addr = 0;
-  static inline bool eepromBeginDone = false;
-  #endif
+  // deferred commits, for buffered backends
+  typedef EEWLCommitState<B> CommitState;
 
-  #ifdef EEWL_RAM
-  uint8_t *buffer;
+  #ifdef EEWL_STATS
+  // wear and performance counters of this object
+  EEWLStats stats = EEWLStats();
   #endif
 
 
   // member functions
 
   // class constructor
-  template <typename T> EEWL(T &data, int blk_num_, int start_addr_) {
+  template <typename T> EEWLBase(T &data, addr_t blk_num_,
+    addr_t start_addr_):
+    EEWLBase(EEWLType<T>(),blk_num_,start_addr_) {
 
     (void)data;
 
+  }
+
+
+  // class constructor from data type only
+  template <typename T> EEWLBase(EEWLType<T>, addr_t blk_num_,
+    addr_t start_addr_) {
+
     // allocate and init control vars
-    blk_size = sizeof(T) + 1;
-    blk_num = blk_num_;
-    start_addr = start_addr_;
-    end_addr = start_addr + blk_num * blk_size;
+    this->template setGeometry<T>(blk_num_,start_addr_);
+    this->reserve(end_addr);
 
-    #if defined(EEWL_RAM)
-    buffer = (uint8_t *)malloc(end_addr);
-    #elif defined(ESP8266) || defined(ESP32) || defined(TARGET_RP2040)
-    if (highest_end_addr < end_addr)
-      highest_end_addr = end_addr;
-    #endif
+  }
+
+
+  // class constructor for compile time geometry
+  EEWLBase(void) {
+
+    this->reserve(end_addr);
 
   }
 
 
+  // size in bytes of a data block holding data of type T
+  template <typename T> static constexpr int blockSize(void) {
+    return G::template blockSize<T>();
+  }
+
+
+  // size in bytes of a circular buffer of blk_num blocks of type T
+  template <typename T> static constexpr int bufferSize(int blk_num_) {
+    return G::template bufferSize<T>(blk_num_);
+  }
+
+
   // class initializer
   void begin() {
 
-    #if !defined(EEWL_RAM) && !defined(__AVR__)
-    if (!eepromBeginDone) {
-      #if defined(ESP8266) || defined(TARGET_RP2040)
-      EEPROM.begin((highest_end_addr / 256 + 1) * 256);
-      #elif defined(ESP32)
-      if (!EEPROM.begin((highest_end_addr / 256 + 1) * 256)) {
-        Serial.println("ERROR: EEPROM init failure");
-        while(true) delay(1000);
-      }
-      delay(500);
-      #endif
-      eepromBeginDone = true;
+    asyncWait();
+    B::begin();
+    locate();
+
+  }
+
+
+  // init a group of EEWL objects of the same type: storage is inited once,
+  // buffers are scanned in one pass in address order and the writes done
+  // by recoveries and formats are committed once.
+  static void beginAll(EEWLBase **eewls, int n) {
+
+    asyncWait();
+    B::begin();
+    Batch batch;
+
+    // locate each object in order of start address, then of array index
+    int last = -1;
+    for (int count = 0; count < n; count++) {
+      int next = -1;
+      for (int i = 0; i < n; i++)
+        if (isAfter(eewls,i,last) && (next < 0 || isAfter(eewls,next,i)))
+          next = i;
+      eewls[next]->locate();
+      last = next;
     }
+
+  }
+
+
+  // true if object i comes after object j (none if j < 0) in beginAll order
+  static bool isAfter(EEWLBase **eewls, int i, int j) {
+
+    return j < 0 || eewls[i]->start_addr > eewls[j]->start_addr
+      || (eewls[i]->start_addr == eewls[j]->start_addr && i > j);
+
+  }
+
+
+  // locate the current data, recovering an interrupted put. A not valid
+  // layout keeps its newest data block, in sequence mode it is formatted.
+  void locate(void) {
+
+    #ifdef EEWL_STATS
+    Timer timer(this,&EEWLStats::begin_us,&EEWLStats::begin_us_max);
+    #endif
+
+    #ifdef EEWL_FAST_BEGIN
+    // sequence mode: binary search with linear scan fallback
+    if (!seqLocate())
+      seqScan();
+    seqVerify();
+    return;
     #endif
 
-    // search for a valid current data
+    // search for the newest data block marker and the one before it.
+    // Bytes not of the marker sequence are left by a torn write.
     blk_addr = 0;
-    int blocks_addr[2];
-    int blocks_count = 0;
-    for (int addr = start_addr; addr < end_addr; addr += blk_size) {
+    addr_t newest = 0, previous = 0;
+    int newest_mark = 0, previous_mark = 0;
+    addr_t blocks_count = 0;
+    for (addr_t addr = start_addr; addr < end_addr; addr += blk_size) {
+      int mark = this->read(addr);
+      if (mark == 0xff)
+        continue;
+      blocks_count++;
+      if (!isMark(mark))
+        continue;
+      if (!newest || isNewer(addr,mark,newest,newest_mark)) {
+        previous = newest;
+        previous_mark = newest_mark;
+        newest = addr;
+        newest_mark = mark;
+      }
+      else if (!previous || isNewer(addr,mark,previous,previous_mark)) {
+        previous = addr;
+        previous_mark = mark;
+      }
+    }
 
-      // find up to two occurrences of a valid data marker
-      if (EE_READ(addr) != 0xff) {
+    // keep the newest data block with a right checksum, if any
+    if (newest && !verify(newest))
+      newest = previous && verify(previous) ? previous : 0;
+    blk_addr = newest;
+
+    // more blocks than the current data: put interrupted by power off or
+    // corrupted layout. Set free all blocks but the current data.
+    if (blocks_count > 1 || (blocks_count && !blk_addr)) {
+      count(&EEWLStats::recoveries);
+      for (addr_t addr = start_addr; addr < end_addr; addr += blk_size)
+        if (addr != blk_addr)
+          clear(addr);
+      commit();
+    }
+  }
+
+
+  // true if the data block at addr with marker mark was written after the
+  // one at other_addr with marker other_mark. Markers rotate over 8 values,
+  // so the newer is the one up to 3 steps ahead. When markers do not tell,
+  // the block following the other one is the newer.
+  bool isNewer(addr_t addr, int mark, addr_t other_addr, int other_mark) {
+
+    int steps = (markIndex(mark) - markIndex(other_mark)) & 7;
+    if (steps && steps < 4)
+      return true;
+    if (steps > 4)
+      return false;
+    return addr == other_addr + blk_size
+      || (addr == start_addr && other_addr == end_addr - blk_size);
+
+  }
 
-	// if more than two valid block, formatting is needed
-	if (++blocks_count > 2) {
-          fastFormat();
-          return;
-	}
 
-        blocks_addr[blocks_count-1] = addr;
+  // locate current data of a sequence mode buffer by binary search.
+  // Returns false if the buffer layout is not the expected one.
+  bool seqLocate(void) {
 
+    int mark = markAt(0);
+    int last = markAt(blk_num - 1);
+
+    // first block free: wrap around put interrupted by power off, all other
+    // blocks are of the current pass. Empty buffer is left to linear scan.
+    if (mark == 0xff) {
+      if (blk_num < 2 || !isMark(last) || markAt(1) != last)
+        return false;
+      count(&EEWLStats::recoveries);
+      blk_addr = start_addr + (blk_num - 1) * blk_size;
+      blk_mark = last;
+      return true;
+    }
+    if (!isMark(mark))
+      return false;
+
+    // search the last block with the same marker of the first one
+    addr_t lo = 0;
+    addr_t hi = blk_num;
+    while (hi - lo > 1) {
+      addr_t mid = (lo + hi) / 2;
+      if (markAt(mid) == mark)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+    // the blocks that follow must be free or of the previous pass
+    if (hi < blk_num) {
+      int prev = prevMark(mark);
+      int next = markAt(hi);
+      if ((next != 0xff && next != prev) || (last != 0xff && last != prev))
+        return false;
+    }
+
+    blk_addr = start_addr + lo * blk_size;
+    blk_mark = mark;
+    return true;
+
+  }
+
+
+  // locate current data of a sequence mode buffer by linear scan checking
+  // the whole buffer layout. Buffer is formatted if layout is not valid.
+  void seqScan(void) {
+
+    int mark = markAt(0);
+    addr_t head = 0;
+    addr_t i = 1;
+
+    // regular layout: blocks of current pass, at most one free block,
+    // blocks of previous pass or free blocks.
+    if (isMark(mark)) {
+      while (i < blk_num && markAt(i) == mark)
+        i++;
+      head = i - 1;
+      if (i < blk_num && markAt(i) == 0xff)
+        i++;
+      int rest = i < blk_num ? markAt(i) : 0xff;
+      if (rest == 0xff || rest == prevMark(mark)) {
+        while (i < blk_num && markAt(i) == rest)
+          i++;
+        if (i == blk_num) {
+          blk_addr = start_addr + head * blk_size;
+          blk_mark = mark;
+          return;
+        }
       }
     }
 
-    // manage the number of valid blocks found (0,1,2)
-    switch (blocks_count) {
+    // first block free: find the other valid blocks
+    else if (mark == 0xff) {
+      addr_t count = 0;
+      for (; i < blk_num; i++) {
+        int m = markAt(i);
+        if (m == 0xff)
+          continue;
+        if (!count++) {
+          head = i;
+          mark = m;
+        }
+        else if (m != mark)
+          break;
+      }
 
       // buffer is empty
-      case 0:
-	break;
-
-      // regular case: one valid data block.
-      case 1:
-	blk_addr = blocks_addr[0];
-	break;
-
-      // incomplete put execution: interrupted by power off.
-      // in this case the two block must be consecutive, check it.
-      case 2:
-
-	// regular consecutive blocks
-	if (blocks_addr[0] + blk_size == blocks_addr[1]) {
-	  blk_addr = blocks_addr[1];
-	  EE_WRITE(blocks_addr[0],0xff);
-	  break;
-	}
-
-	// consecutive blocks wrapped around the end of buffer
-	if (blocks_addr[0] == start_addr) {
-	  blk_addr = start_addr;
-	  EE_WRITE(blocks_addr[1],0xff);
-	  break;
-	}
-
-	// non consecutive blocks, formatting is needed.
-	fastFormat();
+      if (!count) {
+        blk_addr = 0;
+        return;
+      }
+
+      if (i == blk_num && isMark(mark)) {
+
+        // wrap around put interrupted by power off
+        if (count == blk_num - 1) {
+          this->count(&EEWLStats::recoveries);
+          blk_addr = start_addr + (blk_num - 1) * blk_size;
+          blk_mark = mark;
+          return;
+        }
+
+        // one valid block left by the not sequence mode layout:
+        // move it to the first block.
+        if (count == 1) {
+          addr_t head_addr = start_addr + head * blk_size;
+          for (addr_t n = 1; n < blk_size; n++)
+            this->write(start_addr + n,this->read(head_addr + n));
+          this->write(start_addr,mark);
+          this->write(head_addr,0xff);
+          commit();
+          blk_addr = start_addr;
+          blk_mark = mark;
+          return;
+        }
+      }
+    }
+
+    // layout not valid, formatting is needed.
+    count(&EEWLStats::formats);
+    fastFormat();
+
+  }
+
+
+  // step back from the current data of a sequence mode buffer to the
+  // newest data block with a right checksum. Buffer is formatted if there
+  // is no such block.
+  void seqVerify(void) {
+
+    addr_t addr = blk_addr;
+    for (addr_t n = 0; addr && n < blk_num; n++) {
+      if (verify(addr)) {
+        if (addr != blk_addr) {
+          count(&EEWLStats::recoveries);
+          blk_addr = addr;
+          blk_mark = this->read(addr);
+        }
+        return;
+      }
+      addr = (addr == start_addr ? end_addr : addr) - blk_size;
+      if (!isMark(this->read(addr)))
+        break;
+    }
+    if (blk_addr) {
+      count(&EEWLStats::formats);
+      fastFormat();
+    }
+
+  }
+
 
+  // true if the data checksum of data block at addr is right. Always true
+  // with no checksum.
+  bool verify(addr_t addr) {
+
+    if (!EEWLChecksum::size)
+      return true;
+
+    // read data by chunks, to make use of backend block reads
+    EEWLChecksum chk;
+    uint8_t chunk[16];
+    addr_t chk_addr = addr + 1 + data_size;
+    for (addr_t data_addr = addr + 1; data_addr < chk_addr;) {
+      addr_t len = chk_addr - data_addr;
+      if (len > (addr_t)sizeof(chunk))
+        len = sizeof(chunk);
+      this->readBlock(data_addr,chunk,len);
+      chk.add(chunk,len);
+      data_addr += len;
     }
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      if (this->read(chk_addr + i) != ((chk.sum >> (8 * i)) & 0xff))
+        return false;
+    return true;
+
+  }
+
+
+  // data block marker of block at given index
+  int markAt(addr_t index) {
+    return this->read(start_addr + index * blk_size);
+  }
+
+
+  // next marker of the data block marker rotating sequence
+  static int nextMark(int mark) {
+    mark = ((mark << 1) | 1) & 0xff;
+    return mark == 0xff ? 0xfe : mark;
+  }
+
+
+  // previous marker of the data block marker rotating sequence
+  static int prevMark(int mark) {
+    mark = (mark >> 1) | 0x80;
+    return mark == 0xff ? 0x7f : mark;
+  }
+
+
+  // position of the zero bit of a marker of the rotating sequence, 0 to 7
+  static int markIndex(int mark) {
+    int index = 0;
+    while (index < 7 && (mark >> index) & 1)
+      index++;
+    return index;
+  }
+
+
+  // true if argument is a marker of the rotating sequence (one zero bit)
+  static bool isMark(int mark) {
+    int zeros = ~mark & 0xff;
+    return zeros && !(zeros & (zeros - 1));
   }
 
 
   // format essential metadata of circular buffer, buffer is logically cleared.
+  // Markers already free are not written, commit only if some changed.
   void fastFormat(void) {
 
+    asyncWait();
+
     // set all data status bytes as free
-    for (int addr = start_addr; addr < end_addr; addr += blk_size)
-      EE_WRITE(addr,0xff);
+    bool changed = false;
+    for (addr_t addr = start_addr; addr < end_addr; addr += blk_size)
+      changed |= clear(addr);
 
     // mark no valid data available
     blk_addr = 0;
 
-    #if (defined(ESP8266) || defined(ESP32)) || defined(TARGET_RP2040) && !defined(EEWL_RAM)
-    EEPROM.commit();
+    if (changed)
+      commit();
+
+  }
+
+
+  // deep format by steps: the whole buffer, data included, is set to 0xff,
+  // up to len bytes at each call. pos is the offset of the next byte, 0 at
+  // the first call, which clears data logically by a fastFormat. Bytes
+  // already 0xff are not written. Returns the progress percent, 100 when
+  // completed.
+  int deepFormat(addr_t &pos, int len = 16) {
+
+    if (!pos)
+      fastFormat();
+
+    bool changed = false;
+    addr_t size = end_addr - start_addr;
+    for (; len > 0 && pos < size; len--, pos++)
+      changed |= clear(start_addr + pos);
+    if (changed)
+      commit();
+
+    return pos < size ? (uint32_t)pos * 100 / size : 100;
+
+  }
+
+
+  // set byte at addr to 0xff, unless it is already. Returns true if written.
+  bool clear(addr_t addr) {
+
+    if (this->read(addr) == 0xff)
+      return false;
+    this->write(addr,0xff);
+    return true;
+
+  }
+
+
+  // commit EEPROM changes to the storage device, unless commits are
+  // deferred. On backends not buffered it does nothing.
+  static void commit(void) {
+
+    commit(EEWLBool<B::buffered>());
+
+  }
+
+
+  static void commit(EEWLBool<false>) {}
+
+
+  static void commit(EEWLBool<true>) {
+
+    #ifdef EEWL_DEFER_COMMIT
+    CommitState::commitPending = true;
+    #else
+    if (CommitState::batchDepth)
+      CommitState::commitPending = true;
+    else
+      deviceCommit();
     #endif
 
   }
 
 
+  // commit all deferred changes of all EEWL instances with a single
+  // device write. On backends not buffered it does nothing.
+  static void commitAll(void) {
+
+    commitAll(EEWLBool<B::buffered>());
+
+  }
+
+
+  static void commitAll(EEWLBool<false>) {}
+
+
+  static void commitAll(EEWLBool<true>) {
+
+    if (CommitState::commitPending) {
+      deviceCommit();
+      CommitState::commitPending = false;
+    }
+
+  }
+
+
+  // write EEPROM changes to the storage device
+  static void deviceCommit(void) {
+
+    #ifdef EEWL_STATS
+    EEWLStatsTotal<>::stats.commits++;
+    #endif
+    B::commit();
+
+  }
+
+
+  // scoped batch of put/fastFormat calls: commits are deferred while
+  // at least one batch object exists and are done by a single commitAll
+  // when the outermost batch object is destroyed.
+  struct Batch {
+
+    Batch() { batch(EEWLBool<B::buffered>(),1); }
+    ~Batch() { batch(EEWLBool<B::buffered>(),-1); }
+
+  };
+
+
+  static void batch(EEWLBool<false>, int depth) { (void)depth; }
+
+
+  static void batch(EEWLBool<true>, int depth) {
+
+    CommitState::batchDepth += depth;
+    if (!CommitState::batchDepth)
+      commitAll();
+
+  }
+
+
+  // pointer to the current data, in place into the storage RAM buffer,
+  // valid until the next put or fastFormat. Null if there is no valid
+  // data or if the backend does not expose a RAM buffer. Data starts one
+  // byte after the block marker, so T must be byte aligned.
+  template <typename T> const T *peek(void) {
+
+    static_assert(alignof(T) == 1,
+      "EEWL peek requires a byte aligned type, as a packed struct");
+
+    asyncWait();
+
+    if (!blk_addr)
+      return 0;
+    return (const T *)this->dataPtr(blk_addr + 1);
+
+  }
+
+
   // read data from EEPROM
   template <typename T> int get(T &data) {
 
+    asyncWait();
+
     // if no valid data into eeprom, return a ram data null pointer
     if (!blk_addr) return 0;
 
     // else copy data from eeprom to ram
-    uint8_t *ptr = (uint8_t *) &data;
-    for(int data_addr = blk_addr + 1; data_addr < blk_addr + blk_size; data_addr++)
-      *ptr++ = EE_READ(data_addr);
+    this->readBlock(blk_addr + 1,(uint8_t *) &data,sizeof(T));
 
     // return success to mark presence of valid data
     return 1;
@@ -207,54 +1137,356 @@ struct EEWL {
   // write data to EEPROM
   template <typename T> void put(T &data) {
 
-    int old_blk_addr;
-    int new_blk_addr;
+    #ifdef EEWL_STATS
+    Timer timer(this,&EEWLStats::put_us,&EEWLStats::put_us_max);
+    #endif
+
+    asyncWait();
+
+    // compute new block address, mark and data checksum
+    PutState state;
+    putStart(state,(const uint8_t *) &data,sizeof(T));
+    addr_t new_blk_addr = state.new_blk_addr;
+
+    #ifdef EEWL_FAST_BEGIN
+    // sequence mode: set new block free before overwriting its data
+    this->write(new_blk_addr,0xff);
+    #endif
+
+    // write data
+    this->writeBlock(new_blk_addr + 1,(const uint8_t *) &data,sizeof(T));
+
+    // write data checksum
+    uint8_t chk[EEWLChecksum::size + 1] = {0};
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      chk[i] = (state.chk.sum >> (8 * i)) & 0xff;
+    this->writeBlock(new_blk_addr + 1 + sizeof(T),chk,EEWLChecksum::size);
+
+    // write data block data mark
+    this->write(new_blk_addr,state.blk_mark);
+
+    // if it exists, mark old block as free
+    if (state.old_blk_addr)
+      this->write(state.old_blk_addr,0xff);
+
+    putEnd(state);
+
+  }
+
+
+  // start a put sequence of data_size bytes: compute new block address and
+  // mark. If data is null, data is written by the caller, else its checksum
+  // is computed. Control vars are updated only by putEnd.
+  void putStart(PutState &state, const uint8_t *data, int data_size_) {
+
+    state.blk_mark = blk_mark;
 
     // if data already stored in buffer ...
     if (blk_addr) {
 
-      // save current block address and mark and set new mark as free
-      old_blk_addr = blk_addr;
-      blk_mark = EE_READ(blk_addr);
+      // save current block address and mark
+      state.old_blk_addr = blk_addr;
+      #ifndef EEWL_FAST_BEGIN
+      state.blk_mark = this->read(blk_addr);
+      #endif
 
       // point to next data block
-      blk_addr += blk_size;
-      if (blk_addr >= end_addr)
-        blk_addr = start_addr;
+      state.new_blk_addr = blk_addr + blk_size;
+      if (state.new_blk_addr >= end_addr) {
+        state.new_blk_addr = start_addr;
+        #ifdef EEWL_FAST_BEGIN
+        // sequence mode: marker changes at each pass over the buffer
+        state.blk_mark = nextMark(state.blk_mark);
+        #endif
+      }
     }
     // else: no data already stored in buffer ...
     else {
-      old_blk_addr = 0;
-      blk_addr = start_addr;
+      state.old_blk_addr = 0;
+      state.new_blk_addr = start_addr;
     }
 
-    // save new block address
-    new_blk_addr = blk_addr;
+    #ifdef EEWL_FAST_BEGIN
+    // sequence mode: old block is left as it is
+    state.old_blk_addr = 0;
+    #else
+    state.blk_mark = nextMark(state.blk_mark);
+    #endif
 
-    // write data
-    blk_mark <<= 1;
-    blk_mark |= 1;
-    blk_mark &= 0xff;
-    if (blk_mark == 0xff)
-      blk_mark = 0xfe;
-    uint8_t *ptr = (uint8_t *) &data;
-    for(int data_addr = blk_addr + 1; data_addr < blk_addr + blk_size; data_addr++)
-      EE_WRITE(data_addr,*ptr++);
+    state.data = data;
+    state.data_size = data_size_;
+    state.step = 0;
+    state.chk = EEWLChecksum();
+    if (data)
+      state.chk.add(data,data_size_);
 
-    // write data block data mark
-    EE_WRITE(new_blk_addr,blk_mark);
+  }
+
+
+  // next EEPROM write of a put sequence, in the same order of put. Returns
+  // false when there are no more writes.
+  bool putStep(PutState &state, addr_t &addr, uint8_t &val) {
+
+    int step = state.step++;
+
+    // sequence mode: set new block free before overwriting its data
+    if (step == 0) {
+      #ifdef EEWL_FAST_BEGIN
+      addr = state.new_blk_addr;
+      val = 0xff;
+      return true;
+      #else
+      step = state.step++;
+      #endif
+    }
+    step -= 1;
+
+    // data
+    if (step < state.data_size) {
+      addr = state.new_blk_addr + 1 + step;
+      val = state.data[step];
+      return true;
+    }
+    step -= state.data_size;
+
+    // data checksum
+    if (step < EEWLChecksum::size) {
+      addr = state.new_blk_addr + 1 + state.data_size + step;
+      val = (state.chk.sum >> (8 * step)) & 0xff;
+      return true;
+    }
+    step -= EEWLChecksum::size;
+
+    // data block data mark
+    if (step == 0) {
+      addr = state.new_blk_addr;
+      val = state.blk_mark;
+      return true;
+    }
 
     // if it exists, mark old block as free
-    if (old_blk_addr)
-      EE_WRITE(old_blk_addr,0xff);
+    if (step == 1 && state.old_blk_addr) {
+      addr = state.old_blk_addr;
+      val = 0xff;
+      return true;
+    }
+
+    return false;
+
+  }
+
+
+  // end a put sequence: new block becomes the current data, commit.
+  void putEnd(PutState &state) {
 
-    #if (defined(ESP8266) || defined(ESP32)) || defined(TARGET_RP2040) && !defined(EEWL_RAM)
-    EEPROM.commit();
+    blk_addr = state.new_blk_addr;
+    blk_mark = state.blk_mark;
+    count(&EEWLStats::puts);
+    commit();
+
+  }
+
+
+  #ifdef EEWL_ASYNC
+
+  typedef EEWLAsyncState<> async;
+
+
+  // write data to EEPROM in background, driven by the EEPROM ready
+  // interrupt. Data is copied into a staging buffer, so it can be changed
+  // just after the call. If given, done is called by the interrupt handler
+  // at the end of write.
+  template <typename T> void putAsync(T &data, void (*done)(void) = 0) {
+
+    static_assert(sizeof(T) <= EEWL_ASYNC_SIZE,
+      "EEWL data larger than EEWL_ASYNC_SIZE");
+
+    // only one background write at a time
+    asyncWait();
+
+    uint8_t *ptr = (uint8_t *) &data;
+    for (int i = 0; i < (int)sizeof(T); i++)
+      async::buffer[i] = *ptr++;
+    putStart(async::state,async::buffer,sizeof(T));
+    async::eewl = this;
+    async::service = asyncService;
+    async::done = done;
+    async::busy = true;
+
+    // start writing from the interrupt handler
+    EECR |= _BV(EERIE);
+
+  }
+
+
+  // EEPROM ready interrupt service: write the next changed byte of the
+  // background put sequence, or end it.
+  static void asyncService(void) {
+
+    EEWLBase *eewl = (EEWLBase *)async::eewl;
+    addr_t addr;
+    uint8_t val;
+    while (eewl->putStep(async::state,addr,val)) {
+      eewl->count(&EEWLStats::writes);
+      if (eeprom_read_byte((const uint8_t *)addr) == val)
+        eewl->count(&EEWLStats::skipped);
+      else {
+        EEAR = addr;
+        EEDR = val;
+        EECR |= _BV(EEMPE);
+        EECR |= _BV(EEPE);
+        return;
+      }
+    }
+
+    EECR &= ~_BV(EERIE);
+    eewl->putEnd(async::state);
+    async::busy = false;
+    if (async::done)
+      async::done();
+
+  }
+
+  #endif
+
+
+  // true while a background write is in progress
+  static bool busy(void) {
+
+    #ifdef EEWL_ASYNC
+    return async::busy;
+    #else
+    return false;
     #endif
 
   }
 
 
+  // wait for the end of a background write, EEPROM can't be accessed
+  // while it is in progress.
+  static void asyncWait(void) {
+
+    while (busy());
+
+  }
+
+
+  // write data to EEPROM only if it differs from the current saved data
+  template <typename T> int putIfChanged(T &data) {
+
+    asyncWait();
+
+    // if valid data is saved and it is equal to the given one, skip write
+    if (blk_addr) {
+      uint8_t *ptr = (uint8_t *) &data;
+      addr_t data_addr = blk_addr + 1;
+      addr_t data_end = blk_addr + 1 + sizeof(T);
+      while (data_addr < data_end && this->read(data_addr) == *ptr) {
+        data_addr++;
+        ptr++;
+      }
+      if (data_addr == data_end)
+        return 0;
+    }
+
+    // else write data and return success to mark a real write
+    put(data);
+    return 1;
+
+  }
+
+
+  // add n to a counter of this object and to the total one. Without
+  // EEWL_STATS it does nothing.
+  void count(uint32_t EEWLStats::*counter, uint32_t n = 1) {
+
+    #ifdef EEWL_STATS
+    stats.*counter += n;
+    EEWLStatsTotal<>::stats.*counter += n;
+    #else
+    (void)counter; (void)n;
+    #endif
+
+  }
+
+
+  #ifdef EEWL_STATS
+
+  // counters total over all EEWL objects
+  static EEWLStats &totalStats(void) {
+
+    return EEWLStatsTotal<>::stats;
+
+  }
+
+
+  // storage writes, counting written and skipped bytes
+  void write(addr_t addr, uint8_t val) {
+
+    countWrite(addr,&val,1);
+    B::write(addr,val);
+
+  }
+
+
+  void writeBlock(addr_t addr, const uint8_t *data, int len) {
+
+    countWrite(addr,data,len);
+    B::writeBlock(addr,data,len);
+
+  }
+
+
+  void countWrite(addr_t addr, const uint8_t *data, int len) {
+
+    count(&EEWLStats::writes,len);
+    for (int i = 0; i < len; i++)
+      if (B::read(addr + i) == data[i])
+        count(&EEWLStats::skipped);
+
+  }
+
+
+  // scoped timer: saves its life time as last and max duration of this
+  // object and of the total.
+  struct Timer {
+
+    EEWLBase *eewl;
+    uint32_t EEWLStats::*last;
+    uint32_t EEWLStats::*max;
+    uint32_t start_us;
+
+    Timer(EEWLBase *eewl_, uint32_t EEWLStats::*last_,
+      uint32_t EEWLStats::*max_):
+      eewl(eewl_), last(last_), max(max_), start_us(now()) {}
+
+    ~Timer() {
+      uint32_t us = now() - start_us;
+      save(eewl->stats,us);
+      save(EEWLStatsTotal<>::stats,us);
+    }
+
+    void save(EEWLStats &stats, uint32_t us) {
+      stats.*last = us;
+      if (stats.*max < us)
+        stats.*max = us;
+    }
+
+    // microseconds, on host from the steady clock
+    static uint32_t now(void) {
+      #ifdef EEWL_RAM
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+      #else
+      return micros();
+      #endif
+    }
+
+  };
+
+  #endif
+
+
 #ifdef EEWL_DEBUG
 
   void dump_control(void) {
@@ -277,14 +1509,14 @@ struct EEWL {
 
   void dump_buffer(void) {
 
-    for (int addr = start_addr; addr < end_addr;) {
+    for (addr_t addr = start_addr; addr < end_addr;) {
       Serial.print(addr, HEX);
       Serial.print(": ");
-      Serial.print(EE_READ(addr), HEX);
+      Serial.print(this->read(addr), HEX);
       Serial.print("-");
-      int endaddr = addr + blk_size;
+      addr_t endaddr = addr + blk_size;
       for (++addr; addr < endaddr; addr++) {
-        Serial.print(EE_READ(addr),HEX);
+        Serial.print(this->read(addr),HEX);
         Serial.print(" ");
       }
       Serial.println();
@@ -295,6 +1527,25 @@ struct EEWL {
 
 };
 
+typedef EEWLBase<> EEWL;
+
+// EEWL object with compile time geometry: BLK_NUM blocks of data of type T
+// from START_ADDR. Only blk_addr and blk_mark are kept in RAM.
+template <typename T, unsigned long BLK_NUM, unsigned long START_ADDR,
+  class B = EEWLDefaultBackend> using EEWLStatic = EEWLBase<B,B::page_size,
+  EEWLStaticGeometry<T,BLK_NUM,START_ADDR,typename B::addr_t,B::page_size> >;
+
+
+#ifdef EEWL_ASYNC
+
+ISR(EE_READY_vect) {
+
+  EEWLAsyncState<>::service();
+
+}
+
+#endif
+
 #endif
 
 /**** end ****/
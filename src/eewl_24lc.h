@@ -0,0 +1,163 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL storage backend for 24LCxx I2C EEPROM chips
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  Storage backend for I2C EEPROM chips with two address bytes and page
+  writes, like 24LC32 ... 24LC512 and AT24C32 ... AT24C512. Block writes
+  are split into page writes, each one within a chip page and within the
+  Wire transmit buffer, so a data block put takes a few chip write cycles
+  instead of one for each byte. After each write the chip is polled until
+  it acknowledges its address, that is until the write cycle is over.
+  The backend page size is the chip page size, so by default EEWL blocks
+  are aligned to pages and a put writes data and checksum by one page
+  write, when they fit into the Wire transmit buffer.
+
+.usage
+  EEWLBase<EEWL24LC<0x50,32> > eeprom(data,10,16);   // 24LC32 at 0x50
+  ...
+  Wire.begin();
+  eeprom.begin();
+
+.warning
+  Wire must be initialized by Wire.begin before EEWL begin.
+
+.- */
+
+#ifndef EEWL_24LC_H
+#define EEWL_24LC_H
+
+#include <Wire.h>
+#include "eewl.h"
+
+// Wire transmit buffer size
+#ifndef EEWL_WIRE_BUFFER
+  #if defined(BUFFER_LENGTH)
+    #define EEWL_WIRE_BUFFER BUFFER_LENGTH
+  #elif defined(I2C_BUFFER_LENGTH)
+    #define EEWL_WIRE_BUFFER I2C_BUFFER_LENGTH
+  #else
+    #define EEWL_WIRE_BUFFER 32
+  #endif
+#endif
+
+
+/**** class ****/
+
+template <uint8_t I2C_ADDR = 0x50, int PAGE_SIZE = 32> struct EEWL24LC {
+
+  typedef uint32_t addr_t;
+  static const bool buffered = false;
+  static const int page_size = PAGE_SIZE;
+
+  // data bytes of a write transmission, after the two address bytes
+  static const int chunk_size =
+    EEWL_WIRE_BUFFER - 2 < PAGE_SIZE ? EEWL_WIRE_BUFFER - 2 : PAGE_SIZE;
+
+
+  // member functions
+
+  // start a transmission addressing the given EEPROM location
+  static void address(addr_t addr) {
+
+    Wire.beginTransmission(I2C_ADDR);
+    Wire.write((uint8_t)(addr >> 8));
+    Wire.write((uint8_t)(addr & 0xff));
+
+  }
+
+
+  // wait for the end of the chip write cycle
+  static void ackPoll(void) {
+
+    do
+      Wire.beginTransmission(I2C_ADDR);
+    while (Wire.endTransmission() != 0);
+
+  }
+
+
+  static uint8_t read(addr_t addr) {
+
+    uint8_t val;
+    readBlock(addr,&val,1);
+    return val;
+
+  }
+
+
+  // write a byte, skipped when the byte is unchanged
+  static void write(addr_t addr, uint8_t val) {
+
+    if (read(addr) == val)
+      return;
+    address(addr);
+    Wire.write(val);
+    Wire.endTransmission();
+    ackPoll();
+
+  }
+
+
+  // sequential read, split to fit into the Wire receive buffer
+  static void readBlock(addr_t addr, uint8_t *data, int len) {
+
+    while (len > 0) {
+      int n = len < EEWL_WIRE_BUFFER ? len : EEWL_WIRE_BUFFER;
+      address(addr);
+      Wire.endTransmission();
+      Wire.requestFrom(I2C_ADDR,(uint8_t)n);
+      for (int i = 0; i < n; i++)
+        *data++ = Wire.read();
+      addr += n;
+      len -= n;
+    }
+
+  }
+
+
+  // page writes, split at page boundaries and to fit into the Wire
+  // transmit buffer
+  static void writeBlock(addr_t addr, const uint8_t *data, int len) {
+
+    while (len > 0) {
+      int n = PAGE_SIZE - addr % PAGE_SIZE;
+      if (n > chunk_size)
+        n = chunk_size;
+      if (n > len)
+        n = len;
+      address(addr);
+      Wire.write(data,n);
+      Wire.endTransmission();
+      ackPoll();
+      addr += n;
+      data += n;
+      len -= n;
+    }
+
+  }
+
+
+  static void commit(void) {}
+
+
+  static void reserve(addr_t end_addr) { (void)end_addr; }
+
+
+  static void begin(void) {}
+
+
+  static const uint8_t *dataPtr(addr_t addr) { (void)addr; return 0; }
+
+};
+
+#endif
+
+/**** end ****/
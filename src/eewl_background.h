@@ -0,0 +1,207 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL background, EEWL shared object written by a worker
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL background object is an EEWL shared object whose writes are
+  done by a background worker, so put never waits for the block write and
+  the commit, which may stall for tens of milliseconds while flash is
+  written. put stores data into the pending slot and, if the worker is
+  idle, wakes it up. The worker writes and commits pending data until the
+  slot is empty, so a put arriving meanwhile is coalesced with later
+  ones.
+
+  On ESP32 the worker is a FreeRTOS task per object, pinned to the core
+  given to begin. On RP2040 the worker runs on the second core: put pushes
+  the object into the multicore FIFO and EEWLWorker::serve, called by
+  loop1, pops it and writes its pending data, so one worker serves all
+  objects.
+
+.usage
+  EEWLBackground<Parameters> params(10,0x10);
+  ...
+  params.begin(0);                  // in setup, worker on core 0
+  ...
+  params.put(parameters);           // returns at once
+  ...
+  params.flushBlocking();           // before shutdown
+
+  void loop1() {                    // RP2040 only
+    EEWLWorker::serve();
+  }
+
+.warning
+  Data not yet written by the worker is lost at power off, flushBlocking
+  waits until it is written. On RP2040 the multicore FIFO is reserved to
+  the worker.
+
+.- */
+
+#ifndef EEWL_BACKGROUND_H
+#define EEWL_BACKGROUND_H
+
+#include "eewl_shared.h"
+
+#if defined(ESP32) && !defined(EEWL_RAM)
+  #include <freertos/task.h>
+#elif defined(EEWL_RAM)
+  #include <chrono>
+  #include <thread>
+#endif
+
+// stack size of the ESP32 worker task, in bytes, data size excluded
+#ifndef EEWL_TASK_STACK
+  #define EEWL_TASK_STACK 4096
+#endif
+
+
+/**** worker ****/
+
+// a background object as seen by the worker
+struct EEWLWorker {
+
+  void (*write_pending)(EEWLWorker *item);
+
+
+  #if defined(TARGET_RP2040) && !defined(EEWL_RAM)
+  // serve one object pushed into the multicore FIFO, waiting for it. To be
+  // called by loop1.
+  static void serve(void) {
+
+    EEWLWorker *item = (EEWLWorker *) (uintptr_t) rp2040.fifo.pop();
+    item->write_pending(item);
+
+  }
+  #endif
+
+};
+
+
+/**** class ****/
+
+template <typename T, class B = EEWLDefaultBackend>
+struct EEWLBackground : EEWLShared<T,B>, EEWLWorker {
+
+  typedef typename B::addr_t addr_t;
+
+  #if defined(ESP32) && !defined(EEWL_RAM)
+  TaskHandle_t task;
+  #elif defined(EEWL_RAM)
+  std::atomic<bool> wake;
+  #endif
+
+
+  // class constructor
+  EEWLBackground(addr_t blk_num_, addr_t start_addr_):
+    EEWLShared<T,B>(blk_num_,start_addr_) {
+
+    write_pending = writeItem;
+    #if defined(ESP32) && !defined(EEWL_RAM)
+    task = 0;
+    #elif defined(EEWL_RAM)
+    wake = false;
+    #endif
+
+  }
+
+
+  // class initializer, to be called before tasks sharing the object start.
+  // On ESP32 it starts the worker task on the given core and priority.
+  void begin(int core = 0, int priority = 1) {
+
+    EEWLShared<T,B>::begin();
+
+    #if defined(ESP32) && !defined(EEWL_RAM)
+    xTaskCreatePinnedToCore(taskLoop,"eewl",EEWL_TASK_STACK + sizeof(T),this,
+      priority,&task,core);
+    #elif defined(EEWL_RAM)
+    (void) core; (void) priority;
+    std::thread(hostLoop,this).detach();
+    #else
+    (void) core; (void) priority;
+    #endif
+
+  }
+
+
+  // write data to EEPROM by the worker, return at once
+  void put(const T &data) {
+
+    if (this->store(data))
+      notify();
+
+  }
+
+
+  // wait until all data put is written to EEPROM
+  void flushBlocking(void) {
+
+    while (this->busy())
+      #ifdef EEWL_RAM
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      #else
+      delay(1);
+      #endif
+
+  }
+
+
+  // wake up the worker
+  void notify(void) {
+
+    #if defined(ESP32) && !defined(EEWL_RAM)
+    xTaskNotifyGive(task);
+    #elif defined(TARGET_RP2040) && !defined(EEWL_RAM)
+    rp2040.fifo.push((uintptr_t) static_cast<EEWLWorker *>(this));
+    #else
+    wake = true;
+    #endif
+
+  }
+
+
+  // worker entry, write pending data of an object
+  static void writeItem(EEWLWorker *item) {
+
+    static_cast<EEWLBackground *>(item)->writePending();
+
+  }
+
+
+  #if defined(ESP32) && !defined(EEWL_RAM)
+  // worker task: wait for a notification, then write pending data
+  static void taskLoop(void *arg) {
+
+    EEWLBackground *eewlb = (EEWLBackground *) arg;
+    while (true) {
+      ulTaskNotifyTake(pdTRUE,portMAX_DELAY);
+      eewlb->writePending();
+    }
+
+  }
+  #elif defined(EEWL_RAM)
+  // host worker thread, for testing purposes
+  static void hostLoop(EEWLBackground *eewlb) {
+
+    while (true) {
+      if (eewlb->wake.exchange(false))
+        eewlb->writePending();
+      else
+        std::this_thread::yield();
+    }
+
+  }
+  #endif
+
+};
+
+#endif
+
+/**** end ****/
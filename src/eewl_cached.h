@@ -0,0 +1,192 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL cached, RAM write back cache with flush policies
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL cached object keeps a RAM shadow of the data saved into an EEWL
+  circular buffer. The shadow is loaded by begin, get reads the shadow
+  only and put changes the shadow only, marking it dirty. A flush policy
+  decides when the dirty shadow is written to EEPROM by the EEWL
+  putIfChanged, so a burst of changes costs a single write, or none if
+  data is back to its saved value.
+
+.flush_policies
+  A flush policy is a class with the member function
+    bool due(unsigned long now, unsigned long dirty_since,
+      unsigned long last_flush);
+  returning true when a dirty shadow must be written. Times are in
+  milliseconds, from millis. Available policies:
+    EEWLFlushOnDemand       only by an explicit flush call;
+    EEWLFlushInterval<MS>   at most one write every MS milliseconds;
+    EEWLFlushDelay<MS>      MS milliseconds after the first unsaved change.
+
+.usage
+  EEWLCached<Parameters,EEWLFlushDelay<5000> > params(4,0x10);
+  ...
+  params.begin();
+  ...
+  void loop() {
+    params.put(parameters);   // RAM only
+    params.poll();            // write when the policy says so
+    ...
+  }
+
+.warning
+  Changes not yet flushed are lost at power off.
+
+.- */
+
+#ifndef EEWL_CACHED_H
+#define EEWL_CACHED_H
+
+#include "eewl.h"
+
+
+/**** flush policies ****/
+
+struct EEWLFlushOnDemand {
+
+  bool due(unsigned long now, unsigned long dirty_since,
+    unsigned long last_flush) {
+
+    (void)now; (void)dirty_since; (void)last_flush;
+    return false;
+
+  }
+
+};
+
+
+template <unsigned long MS> struct EEWLFlushInterval {
+
+  bool due(unsigned long now, unsigned long dirty_since,
+    unsigned long last_flush) {
+
+    (void)dirty_since;
+    return now - last_flush >= MS;
+
+  }
+
+};
+
+
+template <unsigned long MS> struct EEWLFlushDelay {
+
+  bool due(unsigned long now, unsigned long dirty_since,
+    unsigned long last_flush) {
+
+    (void)last_flush;
+    return now - dirty_since >= MS;
+
+  }
+
+};
+
+
+/**** class ****/
+
+template <typename T, class P = EEWLFlushOnDemand,
+  class B = EEWLDefaultBackend> struct EEWLCached {
+
+  typedef typename B::addr_t addr_t;
+
+  // control vars
+  EEWLBase<B> eewl;
+  P policy;
+  T shadow;
+  bool valid;
+  bool dirty;
+  unsigned long dirty_since;
+  unsigned long last_flush;
+
+
+  // member functions
+
+  // class constructor
+  EEWLCached(addr_t blk_num_, addr_t start_addr_):
+    eewl(EEWLType<T>(),blk_num_,start_addr_), valid(false), dirty(false) {}
+
+
+  // class initializer: load the shadow from EEPROM
+  void begin(void) {
+
+    eewl.begin();
+    valid = eewl.get(shadow);
+    dirty = false;
+    last_flush = millis();
+
+  }
+
+
+  // format the circular buffer, data is logically cleared.
+  void fastFormat(void) {
+
+    eewl.fastFormat();
+    valid = false;
+    dirty = false;
+
+  }
+
+
+  // read data from the shadow
+  int get(T &data) {
+
+    // if no valid data, return failure
+    if (!valid)
+      return 0;
+
+    data = shadow;
+    return 1;
+
+  }
+
+
+  // write data to the shadow, then write it to EEPROM if the policy
+  // says so.
+  void put(const T &data) {
+
+    shadow = data;
+    valid = true;
+    if (!dirty) {
+      dirty = true;
+      dirty_since = millis();
+    }
+    poll();
+
+  }
+
+
+  // write the shadow to EEPROM if it is dirty and the policy says so.
+  // Call it periodically for time based policies.
+  void poll(void) {
+
+    if (dirty && policy.due(millis(),dirty_since,last_flush))
+      flush();
+
+  }
+
+
+  // write the shadow to EEPROM if it is dirty. Returns 1 if there was a
+  // real write.
+  int flush(void) {
+
+    if (!dirty)
+      return 0;
+    dirty = false;
+    last_flush = millis();
+    return eewl.putIfChanged(shadow);
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
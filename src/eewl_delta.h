@@ -0,0 +1,259 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL delta, partial data writes by patch records
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL delta object saves a data struct as full snapshots into an EEWL
+  circular buffer and saves the changes of single struct members as small
+  patch records into a journal placed just after the circular buffer.
+  Patches are replayed over the snapshot by get. A new full snapshot is
+  written, and the journal patches become stale, only when the journal is
+  full or when a full put is requested.
+
+.layout
+  Journal of patch_num slots, each slot is:
+    snapshot marker | snapshot block index | member offset (2 bytes) |
+    member size | member bytes (PATCH_SIZE bytes)
+  The first byte is the slot status byte: 0xff for a free slot, else the
+  marker of the snapshot block the patch applies to. Together with the
+  snapshot block index, it binds the patch to one snapshot, so patches of
+  older snapshots are ignored. The journal is circular: the patches of a
+  snapshot are written from the slot following the last patch of the
+  previous snapshot, the first one has the high bit of member size set.
+
+.endurance
+  Each patch writes one slot, its status byte is cleared by the next
+  snapshot but one, unless a later patch overwrites it. With P patches
+  and S snapshots, the most written journal byte gets up to
+  2 * P / patch_num writes, P / patch_num if the journal is filled before
+  each snapshot, the most written snapshot byte gets 2 * S / blk_num
+  writes. Plain EEWL with the same put count gets 2 * (P + S) / blk_num,
+  so patch_num should not be less than blk_num.
+
+.power_off_safety
+  A patch keeps its slot bound to an older snapshot until its last write:
+  the status byte is written last or, if the slot holds another block
+  index than the current one, first, and the block index last. A new
+  snapshot makes all journal patches stale at once, so an interrupted
+  journal clear cannot mix old patches with new data. Before writing a new
+  snapshot, put clears the patches not bound to the current one, so only
+  patches of the previous snapshot are left.
+
+.- */
+
+#ifndef EEWL_DELTA_H
+#define EEWL_DELTA_H
+
+#include "eewl.h"
+
+
+/**** class ****/
+
+template <typename T, int PATCH_SIZE = 4, class B = EEWLDefaultBackend>
+struct EEWLDelta {
+
+  typedef typename B::addr_t addr_t;
+
+  // patch slot layout
+  static const int slot_size = PATCH_SIZE + 5;
+  static const int slot_index = 1;
+  static const int slot_offset = 2;
+  static const int slot_len = 4;
+  static const int slot_data = 5;
+  static const uint8_t slot_first = 0x80;
+
+  static_assert(PATCH_SIZE < slot_first,
+    "EEWL delta patch size must be less than 128");
+
+  // control vars
+  EEWLBase<B> snapshot;
+  T *ram_data;
+  int patch_num;
+  int patch_count;
+  int first_slot;
+  addr_t journal_addr;
+  addr_t end_addr;
+
+
+  // member functions
+
+  // class constructor
+  EEWLDelta(T &data, addr_t blk_num_, int patch_num_, addr_t start_addr_):
+    snapshot(data,blk_num_,start_addr_) {
+
+    // allocate and init control vars
+    ram_data = &data;
+    patch_num = patch_num_;
+    patch_count = 0;
+    first_slot = 0;
+    journal_addr = snapshot.end_addr;
+    end_addr = journal_addr + patch_num * slot_size;
+    snapshot.reserve(end_addr);
+
+  }
+
+
+  // class initializer: locate the patches of current snapshot and load
+  // saved data into data
+  void begin(void) {
+
+    snapshot.begin();
+
+    // find the first patch of current snapshot and count the following
+    // ones. With no patches, the journal restarts from a slot depending on
+    // the snapshot block, to spread wear across power cycles.
+    patch_count = 0;
+    first_slot = snapshot.blk_addr ?
+      (long) snapshotBlock() * patch_num / snapshot.blk_num : 0;
+    for (int i = 0; i < patch_num; i++) {
+      addr_t slot = journal_addr + i * slot_size;
+      if (isCurrent(slot) && (snapshot.read(slot + slot_len) & slot_first)) {
+        first_slot = i;
+        patch_count = 1;
+        break;
+      }
+    }
+    while (patch_count && patch_count < patch_num
+      && isCurrent(slotAddr(patch_count))
+      && !(snapshot.read(slotAddr(patch_count) + slot_len) & slot_first))
+      patch_count++;
+
+    // load saved data, so a full snapshot written by putField keeps it
+    get(*ram_data);
+
+  }
+
+
+  // format snapshot buffer and journal, data is logically cleared.
+  void fastFormat(void) {
+
+    for (addr_t slot = journal_addr; slot < end_addr; slot += slot_size)
+      snapshot.write(slot,0xff);
+    patch_count = 0;
+    first_slot = 0;
+    snapshot.fastFormat();
+
+  }
+
+
+  // read data from EEPROM: snapshot and its patches
+  int get(T &data) {
+
+    if (!snapshot.get(data))
+      return 0;
+
+    // replay patches in write order, skipping the ones beyond data, as
+    // left by another data type or by a corrupted byte
+    uint8_t *ptr = (uint8_t *) &data;
+    for (int n = 0; n < patch_count; n++) {
+      addr_t slot = slotAddr(n);
+      int offset = snapshot.read(slot + slot_offset)
+        | (snapshot.read(slot + slot_offset + 1) << 8);
+      int len = snapshot.read(slot + slot_len) & ~slot_first;
+      if (offset + len > (int)sizeof(T))
+        continue;
+      for (int i = 0; i < len; i++)
+        ptr[offset + i] = snapshot.read(slot + slot_data + i);
+    }
+
+    return 1;
+
+  }
+
+
+  // write a full snapshot of data to EEPROM
+  void put(T &data) {
+
+    // clear the patches of older snapshots, the new snapshot makes the
+    // current ones stale. The next patch follows the last current one.
+    for (addr_t slot = journal_addr; slot < end_addr; slot += slot_size)
+      if (snapshot.read(slot) != 0xff && !isCurrent(slot))
+        snapshot.write(slot,0xff);
+    snapshot.put(data);
+    first_slot = (first_slot + patch_count) % patch_num;
+    patch_count = 0;
+
+  }
+
+
+  // change data member and write it to EEPROM as a patch record. A full
+  // snapshot is written if there is no snapshot or the journal is full.
+  template <typename M> void putField(M T::*member, const M &value) {
+
+    static_assert(sizeof(M) <= PATCH_SIZE,
+      "EEWL delta member larger than patch size");
+
+    // update ram data
+    ram_data->*member = value;
+
+    if (!snapshot.blk_addr || patch_count >= patch_num) {
+      put(*ram_data);
+      return;
+    }
+
+    // write patch data, binding the slot to current snapshot last: by the
+    // status byte or, if the slot has another block index, by the index
+    addr_t slot = slotAddr(patch_count);
+    int offset = (uint8_t *) &(ram_data->*member) - (uint8_t *) ram_data;
+    uint8_t *ptr = (uint8_t *) &(ram_data->*member);
+    bool index_last = snapshot.read(slot + slot_index) != snapshotIndex();
+    if (index_last)
+      snapshot.write(slot,snapshotMark());
+    snapshot.write(slot + slot_offset,offset & 0xff);
+    snapshot.write(slot + slot_offset + 1,offset >> 8);
+    snapshot.write(slot + slot_len,sizeof(M) | (patch_count ? 0 : slot_first));
+    for (int i = 0; i < (int)sizeof(M); i++)
+      snapshot.write(slot + slot_data + i,*ptr++);
+    if (index_last)
+      snapshot.write(slot + slot_index,snapshotIndex());
+    else
+      snapshot.write(slot,snapshotMark());
+    patch_count++;
+
+    snapshot.commit();
+
+  }
+
+
+  // address of the n-th patch slot of current snapshot
+  addr_t slotAddr(int n) {
+    return journal_addr + (first_slot + n) % patch_num * slot_size;
+  }
+
+
+  // index of current snapshot block
+  int snapshotBlock(void) {
+    return (snapshot.blk_addr - snapshot.start_addr) / snapshot.blk_size;
+  }
+
+
+  // marker of current snapshot block
+  int snapshotMark(void) {
+    return snapshot.markAt(snapshotBlock());
+  }
+
+
+  // low byte of current snapshot block index
+  int snapshotIndex(void) {
+    return snapshotBlock() & 0xff;
+  }
+
+
+  // true if patch slot is bound to the current snapshot
+  bool isCurrent(addr_t slot) {
+    return snapshot.blk_addr && snapshot.read(slot) == snapshotMark()
+      && snapshot.read(slot + slot_index) == snapshotIndex();
+  }
+
+};
+
+#endif
+
+/**** end ****/
@@ -0,0 +1,152 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL emplace, put of data built in place into the new block
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL emplace object does a put of an EEWL object without a RAM copy
+  of data: open selects the new block, the one put would write, then data
+  fields are written straight into it and publish writes checksum, data
+  marker and free of the old block, in the same order of put. The new
+  block may start as a copy of the current data, so only changed fields
+  are written.
+
+.power_off_safety
+  Until publish writes the data marker, the new block is free and the
+  current data is untouched, so a power off before publish loses the new
+  data only, as an interrupted put.
+
+.usage
+  EEWLEmplace<Parameters> staged(sysParms);
+  ...
+  staged.open(true);                                    // copy current
+  staged.set(offsetof(Parameters,gain),gain);
+  staged.write(offsetof(Parameters,name),name,sizeof(name));
+  staged.publish();
+
+.warning
+  Without copy, all data bytes must be written before publish. No other
+  put or fastFormat of the same EEWL object while open.
+
+.- */
+
+#ifndef EEWL_EMPLACE_H
+#define EEWL_EMPLACE_H
+
+#include "eewl.h"
+
+
+/**** class ****/
+
+template <typename T, class E = EEWL> struct EEWLEmplace {
+
+  typedef typename E::addr_t addr_t;
+
+  // control vars
+  E &eewl;
+  typename E::PutState state;
+  bool pending;
+
+
+  // member functions
+
+  // class constructor
+  EEWLEmplace(E &eewl_): eewl(eewl_), pending(false) {}
+
+
+  // open the new block. If copy is true, it starts as a copy of the
+  // current data, if any.
+  void open(bool copy = false) {
+
+    eewl.asyncWait();
+    eewl.putStart(state,0,sizeof(T));
+    addr_t addr = state.new_blk_addr;
+
+    #ifdef EEWL_FAST_BEGIN
+    // sequence mode: set new block free before overwriting its data
+    eewl.write(addr,0xff);
+    #endif
+
+    if (copy && eewl.blk_addr) {
+      uint8_t chunk[16];
+      for (addr_t i = 0; i < sizeof(T); i += sizeof(chunk)) {
+        int len = sizeof(T) - i < sizeof(chunk) ? sizeof(T) - i
+          : sizeof(chunk);
+        eewl.readBlock(eewl.blk_addr + 1 + i,chunk,len);
+        eewl.writeBlock(addr + 1 + i,chunk,len);
+      }
+    }
+    pending = true;
+
+  }
+
+
+  // write len bytes at offset from data start
+  void write(addr_t offset, const void *data, int len) {
+
+    eewl.writeBlock(state.new_blk_addr + 1 + offset,(const uint8_t *) data,
+      len);
+
+  }
+
+
+  // write a field at offset from data start
+  template <typename F> void set(addr_t offset, const F &field) {
+
+    write(offset,&field,sizeof(F));
+
+  }
+
+
+  // end the put: write checksum, computed over the new block data, data
+  // marker and free of the old block. The new block becomes the current
+  // data.
+  void publish(void) {
+
+    if (!pending)
+      return;
+    pending = false;
+    addr_t addr = state.new_blk_addr;
+
+    // data checksum
+    if (EEWLChecksum::size) {
+      uint8_t chunk[16];
+      for (addr_t i = 0; i < sizeof(T); i += sizeof(chunk)) {
+        int len = sizeof(T) - i < sizeof(chunk) ? sizeof(T) - i
+          : sizeof(chunk);
+        eewl.readBlock(addr + 1 + i,chunk,len);
+        state.chk.add(chunk,len);
+      }
+      uint8_t chk[EEWLChecksum::size + 1] = {0};
+      for (int i = 0; i < EEWLChecksum::size; i++)
+        chk[i] = (state.chk.sum >> (8 * i)) & 0xff;
+      eewl.writeBlock(addr + 1 + sizeof(T),chk,EEWLChecksum::size);
+    }
+
+    // data block marker, then free of the old block
+    eewl.write(addr,state.blk_mark);
+    if (state.old_blk_addr)
+      eewl.write(state.old_blk_addr,0xff);
+    eewl.putEnd(state);
+
+  }
+
+
+  // true while a block is open
+  bool busy(void) {
+
+    return pending;
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
@@ -0,0 +1,513 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL flash, wear leveled data on raw NOR flash sectors
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL flash object saves data into a ring of raw NOR flash sectors,
+  without the EEPROM emulation layer, which rewrites a whole flash sector
+  at each commit. On NOR flash, a program can only clear bits (1 -> 0), a
+  bit can be set back to 1 only by erasing its whole sector. So here data
+  blocks are never rewritten: each put programs the next erased block and
+  a sector is erased only when a put moves into it, once for each pass
+  over the ring.
+
+.layout
+  Each sector starts with a header of two 32 bit words, the sector
+  sequence number and its complement, written just after the sector erase.
+  Data blocks follow, in the EEWL layout: marker, data, checksum. The
+  block marker only clears bits at each state change:
+    0xff  FREE     erased, never written
+    0x7f  CLAIMED  write started
+    0x3f  VALID    data and checksum written
+    0x00  CLEARED  no data from here backward, written by fastFormat
+  The current data is the last valid block of the sector with the highest
+  sequence number, or of the previous sectors if it has none. Block age
+  comes from its position, so old blocks are not marked superseded.
+
+.power_off_safety
+  An interrupted put leaves a CLAIMED block, never reused until the next
+  erase of its sector. An interrupted erase leaves a sector without a
+  valid header, erased again by the next put moving into it. The sector
+  holding the current data is never erased: if interrupted puts filled
+  all the other sectors with CLAIMED blocks, the full sector is erased
+  again, with the same sequence number, instead of the next one.
+
+.flash_backends
+  A flash backend has the following members, static or not:
+    typedef ... addr_t;
+    static const addr_t sector_size;
+    uint8_t read(addr_t addr);
+    void readBlock(addr_t addr, uint8_t *data, int len);
+    void program(addr_t addr, const uint8_t *data, int len);  clear bits
+    void erase(addr_t addr);        erase the sector starting at addr
+    void reserve(addr_t end_addr);  flash up to end_addr is used
+    void begin(void);
+  Available backends, EEWLDefaultFlash is the one of the target:
+    EEWLRamFlash<SECTOR_SIZE>  RAM buffer with flash semantics (EEWL_RAM)
+    EEWLRp2040Flash            RP2040, addresses are flash offsets
+    EEWLEsp32Flash             ESP32, data partition labelled "eewl"
+    EEWLEsp8266Flash           ESP8266, addresses are flash offsets
+
+.usage
+  EEWLFlash<Parameters> params(2,0x1f0000);   // 2 sectors from offset
+  ...
+  params.begin();
+  params.put(parameters);
+
+.warning
+  The flash region must be sector aligned and not used by anything else:
+  program, file system or EEPROM emulation.
+
+.- */
+
+#ifndef EEWL_FLASH_H
+#define EEWL_FLASH_H
+
+#include "eewl.h"
+
+#if !defined(EEWL_RAM) && defined(TARGET_RP2040)
+  #include <hardware/flash.h>
+#elif !defined(EEWL_RAM) && defined(ESP32)
+  #include <esp_partition.h>
+#elif !defined(EEWL_RAM) && defined(ESP8266)
+  extern "C" {
+  #include "spi_flash.h"
+  }
+#elif !defined(EEWL_RAM)
+  #error ERROR: EEWL flash requires RP2040, ESP32 or ESP8266
+#endif
+
+
+/**** flash backends ****/
+
+// RAM buffer with NOR flash semantics, for testing pourposes. The buffer
+// is extended at each reserve to cover the reserved addresses.
+template <int SECTOR_SIZE = 4096> struct EEWLRamFlash {
+
+  typedef uint32_t addr_t;
+  static const addr_t sector_size = SECTOR_SIZE;
+
+  uint8_t *buffer = 0;
+  addr_t size = 0;
+
+  uint8_t read(addr_t addr) { return buffer[addr]; }
+
+  void readBlock(addr_t addr, uint8_t *data, int len) {
+    memcpy(data,buffer + addr,len);
+  }
+
+  void program(addr_t addr, const uint8_t *data, int len) {
+    while (len--)
+      buffer[addr++] &= *data++;
+  }
+
+  void erase(addr_t addr) { memset(buffer + addr,0xff,sector_size); }
+
+  void reserve(addr_t end_addr) {
+    if (end_addr <= size)
+      return;
+    buffer = (uint8_t *)realloc(buffer,end_addr);
+    memset(buffer + size,0xff,end_addr - size);
+    size = end_addr;
+  }
+
+  static void begin(void) {}
+
+};
+
+
+#if !defined(EEWL_RAM) && defined(TARGET_RP2040)
+
+// RP2040 flash, read by XIP. Programs are done by whole 256 bytes pages,
+// filled with 0xff out of the given bytes, so other bits are unchanged.
+// While programming, interrupts are disabled and the other core is idle,
+// since flash can't be read.
+struct EEWLRp2040Flash {
+
+  typedef uint32_t addr_t;
+  static const addr_t sector_size = FLASH_SECTOR_SIZE;
+
+  static uint8_t read(addr_t addr) {
+    return *(const uint8_t *)(XIP_BASE + addr);
+  }
+
+  static void readBlock(addr_t addr, uint8_t *data, int len) {
+    memcpy(data,(const uint8_t *)(XIP_BASE + addr),len);
+  }
+
+  static void program(addr_t addr, const uint8_t *data, int len) {
+    uint8_t page[FLASH_PAGE_SIZE];
+    while (len > 0) {
+      addr_t page_addr = addr - addr % FLASH_PAGE_SIZE;
+      int offset = addr - page_addr;
+      int n = FLASH_PAGE_SIZE - offset < len ? FLASH_PAGE_SIZE - offset : len;
+      memset(page,0xff,FLASH_PAGE_SIZE);
+      memcpy(page + offset,data,n);
+      noInterrupts();
+      rp2040.idleOtherCore();
+      flash_range_program(page_addr,page,FLASH_PAGE_SIZE);
+      rp2040.resumeOtherCore();
+      interrupts();
+      addr += n;
+      data += n;
+      len -= n;
+    }
+  }
+
+  static void erase(addr_t addr) {
+    noInterrupts();
+    rp2040.idleOtherCore();
+    flash_range_erase(addr,sector_size);
+    rp2040.resumeOtherCore();
+    interrupts();
+  }
+
+  static void reserve(addr_t end_addr) { (void)end_addr; }
+
+  static void begin(void) {}
+
+};
+
+typedef EEWLRp2040Flash EEWLDefaultFlash;
+
+#endif
+
+
+#if !defined(EEWL_RAM) && defined(ESP32)
+
+// ESP32 flash, addresses are offsets into the data partition labelled
+// "eewl", found by begin. Flash sectors are 4096 bytes.
+struct EEWLEsp32Flash {
+
+  typedef uint32_t addr_t;
+  static const addr_t sector_size = 4096;
+
+  static inline const esp_partition_t *partition = 0;
+
+  static uint8_t read(addr_t addr) {
+    uint8_t val;
+    esp_partition_read(partition,addr,&val,1);
+    return val;
+  }
+
+  static void readBlock(addr_t addr, uint8_t *data, int len) {
+    esp_partition_read(partition,addr,data,len);
+  }
+
+  static void program(addr_t addr, const uint8_t *data, int len) {
+    esp_partition_write(partition,addr,data,len);
+  }
+
+  static void erase(addr_t addr) {
+    esp_partition_erase_range(partition,addr,sector_size);
+  }
+
+  static void reserve(addr_t end_addr) { (void)end_addr; }
+
+  static void begin(void) {
+    if (partition)
+      return;
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+      ESP_PARTITION_SUBTYPE_ANY,"eewl");
+    if (!partition) {
+      Serial.println("ERROR: no eewl flash partition");
+      while(true) delay(1000);
+    }
+  }
+
+};
+
+typedef EEWLEsp32Flash EEWLDefaultFlash;
+
+#endif
+
+
+#if !defined(EEWL_RAM) && defined(ESP8266)
+
+// ESP8266 flash: SDK accesses are by aligned 32 bit words, so bytes are
+// read and programmed within their words, other bytes programmed as 0xff.
+struct EEWLEsp8266Flash {
+
+  typedef uint32_t addr_t;
+  static const addr_t sector_size = SPI_FLASH_SEC_SIZE;
+
+  static uint8_t read(addr_t addr) {
+    uint32_t word;
+    spi_flash_read(addr & ~3,&word,4);
+    return word >> (8 * (addr & 3));
+  }
+
+  static void readBlock(addr_t addr, uint8_t *data, int len) {
+    while (len--)
+      *data++ = read(addr++);
+  }
+
+  static void program(addr_t addr, const uint8_t *data, int len) {
+    while (len > 0) {
+      uint32_t word = 0xffffffff;
+      int shift = 8 * (addr & 3);
+      do {
+        word &= ~((uint32_t)0xff << shift) | ((uint32_t)*data++ << shift);
+        shift += 8;
+        addr++;
+        len--;
+      } while (len > 0 && (addr & 3));
+      noInterrupts();
+      spi_flash_write((addr - 1) & ~3,&word,4);
+      interrupts();
+    }
+  }
+
+  static void erase(addr_t addr) {
+    noInterrupts();
+    spi_flash_erase_sector(addr / sector_size);
+    interrupts();
+  }
+
+  static void reserve(addr_t end_addr) { (void)end_addr; }
+
+  static void begin(void) {}
+
+};
+
+typedef EEWLEsp8266Flash EEWLDefaultFlash;
+
+#endif
+
+
+#ifdef EEWL_RAM
+typedef EEWLRamFlash<> EEWLDefaultFlash;
+#endif
+
+
+/**** class ****/
+
+template <typename T, class F = EEWLDefaultFlash> struct EEWLFlash: F {
+
+  typedef typename F::addr_t addr_t;
+
+  // block markers
+  static const uint8_t FREE = 0xff;
+  static const uint8_t CLAIMED = 0x7f;
+  static const uint8_t VALID = 0x3f;
+  static const uint8_t CLEARED = 0x00;
+
+  // sector layout
+  static const addr_t header_size = 8;
+  static const addr_t blk_size = sizeof(T) + 1 + EEWLChecksum::size;
+  static const addr_t sector_blk_num = (F::sector_size - header_size)
+    / blk_size;
+
+  static_assert(sector_blk_num > 0, "EEWL data larger than a flash sector");
+
+  // control vars
+  addr_t start_addr;
+  addr_t sector_num;
+  addr_t sector;
+  uint32_t seq;
+  addr_t next_index;
+  addr_t blk_addr;
+  bool valid;
+
+
+  // member functions
+
+  // class constructor: ring of sector_num_ sectors from start_addr_, a
+  // sector boundary.
+  EEWLFlash(addr_t sector_num_, addr_t start_addr_):
+    start_addr(start_addr_), sector_num(sector_num_ < 2 ? 2 : sector_num_),
+    sector(0), seq(0), next_index(sector_blk_num), blk_addr(0),
+    valid(false) {
+
+    this->reserve(start_addr + sector_num * F::sector_size);
+
+  }
+
+
+  // class initializer: locate the newest sector and the current data
+  void begin(void) {
+
+    F::begin();
+
+    // newest sector: highest sequence number with a valid header
+    seq = 0;
+    sector = sector_num - 1;
+    for (addr_t i = 0; i < sector_num; i++) {
+      uint32_t s;
+      if (sectorSeq(i,s) && (!seq || (int32_t)(s - seq) > 0)) {
+        seq = s;
+        sector = i;
+      }
+    }
+
+    // next free block of the newest sector, none if no valid sector
+    next_index = sector_blk_num;
+    if (seq)
+      for (next_index = 0; next_index < sector_blk_num; next_index++)
+        if (this->read(blockAddr(sector,next_index)) == FREE)
+          break;
+
+    // current data: the last verified valid block, from the newest sector
+    // backward, up to a cleared block.
+    valid = false;
+    addr_t s = sector;
+    uint32_t sq = seq;
+    addr_t index = next_index;
+    for (addr_t n = 0; sq && n < sector_num; n++) {
+      while (index--) {
+        addr_t addr = blockAddr(s,index);
+        uint8_t mark = this->read(addr);
+        if (mark == CLEARED)
+          return;
+        if (mark == VALID && verify(addr)) {
+          blk_addr = addr;
+          valid = true;
+          return;
+        }
+      }
+
+      // move to the previous sector, if it is of the previous pass step
+      s = (s + sector_num - 1) % sector_num;
+      uint32_t prev;
+      if (!sectorSeq(s,prev) || prev != --sq)
+        return;
+      index = sector_blk_num;
+    }
+
+  }
+
+
+  // format the ring: a cleared marker hides all previous data.
+  void fastFormat(void) {
+
+    uint8_t mark = CLEARED;
+    this->program(claimBlock(),&mark,1);
+    valid = false;
+
+  }
+
+
+  // read data from flash
+  int get(T &data) {
+
+    if (!valid)
+      return 0;
+    this->readBlock(blk_addr + 1,(uint8_t *) &data,sizeof(T));
+    return 1;
+
+  }
+
+
+  // write data into the next free block: claim it, write data and
+  // checksum, then mark it valid.
+  void put(T &data) {
+
+    addr_t addr = claimBlock();
+    uint8_t mark = CLAIMED;
+    this->program(addr,&mark,1);
+    this->program(addr + 1,(const uint8_t *) &data,sizeof(T));
+    EEWLChecksum chk;
+    chk.add((const uint8_t *) &data,sizeof(T));
+    uint8_t chk_bytes[EEWLChecksum::size + 1] = {0};
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      chk_bytes[i] = (chk.sum >> (8 * i)) & 0xff;
+    this->program(addr + 1 + sizeof(T),chk_bytes,EEWLChecksum::size);
+    mark = VALID;
+    this->program(addr,&mark,1);
+    blk_addr = addr;
+    valid = true;
+
+  }
+
+
+  // write data only if it differs from the current saved data
+  int putIfChanged(T &data) {
+
+    if (valid) {
+      uint8_t *ptr = (uint8_t *) &data;
+      addr_t i = 0;
+      while (i < sizeof(T) && this->read(blk_addr + 1 + i) == ptr[i])
+        i++;
+      if (i == sizeof(T))
+        return 0;
+    }
+    put(data);
+    return 1;
+
+  }
+
+
+  // address of the next free block, taken from the next sector when the
+  // current one is full. The next sector is erased and gets the next
+  // sequence number, unless it holds the current data: then the full
+  // sector, that has no valid block, is erased again.
+  addr_t claimBlock(void) {
+
+    if (next_index >= sector_blk_num) {
+      addr_t next = (sector + 1) % sector_num;
+      addr_t next_addr = start_addr + next * F::sector_size;
+      if (!valid || blk_addr < next_addr
+        || blk_addr >= next_addr + F::sector_size) {
+        sector = next;
+        seq = seq + 1 ? seq + 1 : 1;
+      }
+      addr_t addr = start_addr + sector * F::sector_size;
+      this->erase(addr);
+      uint32_t header[2] = {seq, ~seq};
+      this->program(addr,(const uint8_t *) header,header_size);
+      next_index = 0;
+    }
+    return blockAddr(sector,next_index++);
+
+  }
+
+
+  // sequence number of a sector, false if its header is not valid
+  bool sectorSeq(addr_t s, uint32_t &sq) {
+
+    uint32_t header[2];
+    this->readBlock(start_addr + s * F::sector_size,(uint8_t *) header,
+      header_size);
+    sq = header[0];
+    return sq && sq != 0xffffffff && header[1] == ~sq;
+
+  }
+
+
+  // address of a block, given sector and block index
+  addr_t blockAddr(addr_t s, addr_t index) {
+
+    return start_addr + s * F::sector_size + header_size + index * blk_size;
+
+  }
+
+
+  // true if the data checksum of data block at addr is right. Always true
+  // with no checksum.
+  bool verify(addr_t addr) {
+
+    if (!EEWLChecksum::size)
+      return true;
+    EEWLChecksum chk;
+    for (addr_t i = 0; i < sizeof(T); i++)
+      chk.add(this->read(addr + 1 + i));
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      if (this->read(addr + 1 + sizeof(T) + i)
+        != ((chk.sum >> (8 * i)) & 0xff))
+        return false;
+    return true;
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
@@ -0,0 +1,204 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL log, wear leveled ring of records
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL log keeps the history of the last records appended to an EEWL
+  circular buffer, instead of the latest data only. It uses the sequence
+  mode layout (see eewl.h) whatever the EEWL compile options are: records
+  are never set free, the block marker changes at each pass over the
+  buffer and the newest record is located at begin by a binary search.
+  When the buffer is full, each append overwrites the oldest record.
+
+.power_off_safety
+  As the sequence mode put, an append sets the new block free, then
+  writes data, checksum and marker. An interrupted append loses the new
+  record and the oldest one only, the one being overwritten.
+
+.usage
+  EEWLLog<Sample> samples(64,0x10);
+  ...
+  samples.begin();
+  samples.append(sample);
+  for (int i = 0; i < samples.count(); i++)
+    samples.get(i,sample);   // from oldest to newest
+
+.- */
+
+#ifndef EEWL_LOG_H
+#define EEWL_LOG_H
+
+#include "eewl.h"
+
+
+/**** class ****/
+
+template <typename T, class B = EEWLDefaultBackend> struct EEWLLog {
+
+  typedef typename B::addr_t addr_t;
+
+  // control vars
+  EEWLBase<B> ring;
+  int first_index;
+  int record_num;
+
+
+  // member functions
+
+  // class constructor
+  EEWLLog(addr_t blk_num_, addr_t start_addr_):
+    ring(EEWLType<T>(),blk_num_,start_addr_), first_index(0), record_num(0) {}
+
+
+  // class initializer: locate the newest record, then the oldest one
+  void begin(void) {
+
+    ring.asyncWait();
+    ring.B::begin();
+    if (!ring.seqLocate())
+      ring.seqScan();
+    ring.seqVerify();
+
+    first_index = 0;
+    record_num = 0;
+    if (!ring.blk_addr)
+      return;
+
+    // the oldest record follows the newest one, possibly after a block
+    // set free by an interrupted append. Otherwise it is the first block.
+    int head = headIndex();
+    int next = (head + 1) % ring.blk_num;
+    if (isRecord(next,head))
+      first_index = next;
+    else if (isRecord((head + 2) % ring.blk_num,head))
+      first_index = (head + 2) % ring.blk_num;
+    record_num = (head - first_index + ring.blk_num) % ring.blk_num + 1;
+
+  }
+
+
+  // format the circular buffer, all records are cleared.
+  void fastFormat(void) {
+
+    ring.fastFormat();
+    first_index = 0;
+    record_num = 0;
+
+  }
+
+
+  // number of records, up to the circular buffer length
+  int count(void) {
+
+    return record_num;
+
+  }
+
+
+  // read record i, from 0 (oldest) to count() - 1 (newest). Returns 0 if
+  // there is no such record or if its checksum is wrong.
+  int get(int i, T &data) {
+
+    ring.asyncWait();
+
+    if (i < 0 || i >= record_num)
+      return 0;
+    addr_t addr = ring.start_addr
+      + (first_index + i) % ring.blk_num * ring.blk_size;
+    if (!ring.verify(addr))
+      return 0;
+    ring.readBlock(addr + 1,(uint8_t *) &data,sizeof(T));
+    return 1;
+
+  }
+
+
+  // append a record, overwriting the oldest one when the buffer is full
+  void append(const T &data) {
+
+    write(data);
+    ring.commit();
+
+  }
+
+
+  // append n records with a single commit
+  void appendMany(const T *data, int n) {
+
+    typename EEWLBase<B>::Batch batch;
+    for (int i = 0; i < n; i++)
+      append(data[i]);
+
+  }
+
+
+  // write a record into the block following the newest one
+  void write(const T &data) {
+
+    ring.asyncWait();
+
+    // compute new block address and mark
+    int mark = ring.blk_mark;
+    addr_t addr = ring.start_addr;
+    if (ring.blk_addr) {
+      addr = ring.blk_addr + ring.blk_size;
+      if (addr >= ring.end_addr) {
+        addr = ring.start_addr;
+        mark = ring.nextMark(mark);
+      }
+    }
+    EEWLChecksum chk;
+    chk.add((const uint8_t *) &data,sizeof(T));
+    uint8_t chk_bytes[EEWLChecksum::size + 1] = {0};
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      chk_bytes[i] = (chk.sum >> (8 * i)) & 0xff;
+
+    // set new block free, write data, checksum and data block marker
+    ring.write(addr,0xff);
+    ring.writeBlock(addr + 1,(const uint8_t *) &data,sizeof(T));
+    ring.writeBlock(addr + 1 + sizeof(T),chk_bytes,EEWLChecksum::size);
+    ring.write(addr,mark);
+
+    // new block becomes the newest record, it may replace the oldest one
+    ring.blk_addr = addr;
+    ring.blk_mark = mark;
+    int head = headIndex();
+    if (!record_num)
+      first_index = head;
+    if (record_num && head == first_index)
+      first_index = (first_index + 1) % ring.blk_num;
+    else
+      record_num++;
+
+  }
+
+
+  // index of the newest record block
+  int headIndex(void) {
+
+    return (ring.blk_addr - ring.start_addr) / ring.blk_size;
+
+  }
+
+
+  // true if block at index holds a record, given the newest record index:
+  // blocks up to it are of the current pass, the others of the previous one.
+  bool isRecord(int index, int head) {
+
+    int mark = index <= head ? ring.blk_mark : ring.prevMark(ring.blk_mark);
+    return ring.markAt(index) == mark;
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
@@ -0,0 +1,369 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL packed, ring of variable length compressed data records
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL packed object saves data compressed into a ring of variable
+  length records, so data mostly made of zeros, or of default values,
+  takes less EEPROM bytes for each put and more puts fit into the same
+  buffer size, extending its life. Data is XORed with optional default
+  data, so members left at their default value become zeros, then zero
+  runs are packed.
+
+.codec
+  The encoded data is a sequence of runs, each starting with a control
+  byte c: 0x00 to 0x7f, c + 1 literal bytes follow; 0x80 to 0xff, a run of
+  c - 0x7f zero bytes. Single zeros within literal bytes are kept as
+  literals.
+
+.layout
+  Record: marker (0xfe) | encoded length (1 byte, 2 if encoded data may
+  exceed 255 bytes) | encoded data | checksum (with EEWL_CRC8, ...).
+  Records are appended one after the other from the ring start, the byte
+  following the newest record is always free (0xff), so begin finds the
+  newest record walking the records from the ring start. When a record
+  does not fit before the ring end, it is written at the ring start, after
+  saving the address of the newest record into a 2 blocks EEWL buffer, the
+  anchor, preceding the ring.
+
+.power_off_safety
+  A put first sets free the byte following the new record, then writes
+  length, data and checksum, and the marker last, so an interrupted put
+  leaves the previous record as the newest one. A put at the ring start
+  first sets free the marker there: if it is interrupted, begin finds no
+  record from the ring start and walks the records from the one saved
+  into the anchor, so puts done after it are found too, until a put at the
+  ring start completes. If the newest record checksum is wrong, the
+  previous one is taken.
+
+.usage
+  const Parameters defaults;
+  EEWLPacked<Parameters> params(200,0x10,&defaults);
+  ...
+  params.begin();
+  params.put(parameters);
+
+.warning
+  The ring size is at least three times maxRecordSize, so a record
+  written at the ring start never overlaps the newest one: a smaller size
+  given to the constructor is raised to it.
+
+.- */
+
+#ifndef EEWL_PACKED_H
+#define EEWL_PACKED_H
+
+#include "eewl.h"
+
+
+/**** class ****/
+
+template <typename T, class B = EEWLDefaultBackend> struct EEWLPacked {
+
+  typedef typename B::addr_t addr_t;
+
+  // record layout
+  static const uint8_t MARK = 0xfe;
+  static const int data_max = sizeof(T) + sizeof(T) / 128 + 2;
+  static const int len_size = data_max < 256 ? 1 : 2;
+  static const int head_size = 1 + len_size;
+
+  // control vars
+  EEWLBase<B> anchor;
+  const T *defaults;
+  addr_t ring_addr;
+  addr_t end_addr;
+  addr_t rec_addr;
+  addr_t rec_len;
+
+
+  // member functions
+
+  // class constructor: the ring of size bytes, at least three times
+  // maxRecordSize, follows the anchor buffer at start_addr. Optional
+  // defaults are XORed with data before packing.
+  EEWLPacked(addr_t size_, addr_t start_addr_, const T *defaults_ = 0):
+    anchor(EEWLType<addr_t>(),2,start_addr_), defaults(defaults_),
+    rec_addr(0), rec_len(0) {
+
+    addr_t min_size = 3 * maxRecordSize();
+    ring_addr = anchor.end_addr;
+    end_addr = ring_addr + (size_ < min_size ? min_size : size_);
+    anchor.reserve(end_addr);
+
+  }
+
+
+  // maximum size in bytes of a record
+  static constexpr int maxRecordSize(void) {
+    return head_size + data_max + EEWLChecksum::size;
+  }
+
+
+  // class initializer: locate the newest record
+  void begin(void) {
+
+    anchor.begin();
+
+    // walk the records from the ring start. If there is none, a put at
+    // the ring start was interrupted by power off: walk the records from
+    // the one saved into the anchor, later puts may have followed it.
+    addr_t saved;
+    if (!walk(ring_addr) && anchor.get(saved))
+      walk(saved);
+
+  }
+
+
+  // walk the records from addr: the newest one becomes the current record,
+  // or the previous one, if the newest checksum is wrong. Returns false if
+  // there is no current record.
+  bool walk(addr_t addr) {
+
+    rec_addr = 0;
+    addr_t previous = 0;
+    addr_t len, previous_len = 0;
+    for (; isRecord(addr,len); addr += recordSize(len)) {
+      previous = rec_addr;
+      previous_len = rec_len;
+      rec_addr = addr;
+      rec_len = len;
+    }
+
+    // newest record corrupted: keep the previous one
+    if (rec_addr && !verify(rec_addr,rec_len)) {
+      rec_addr = previous;
+      rec_len = previous_len;
+    }
+    return rec_addr != 0;
+
+  }
+
+
+  // format the ring, data is logically cleared.
+  void fastFormat(void) {
+
+    anchor.fastFormat();
+    if (anchor.clear(ring_addr))
+      anchor.commit();
+    rec_addr = 0;
+
+  }
+
+
+  // read data from EEPROM. Returns 0 if there is no saved data.
+  int get(T &data) {
+
+    if (!rec_addr)
+      return 0;
+    return decode(rec_addr + head_size,rec_len,data);
+
+  }
+
+
+  // write data to EEPROM
+  void put(const T &data) {
+
+    Counter counter;
+    encode(data,counter);
+    addr_t len = counter.len;
+    addr_t size = recordSize(len);
+
+    // new record after the newest one, if it fits, else at the ring start
+    addr_t addr = rec_addr ? rec_addr + recordSize(rec_len) : ring_addr;
+    if (addr + size > end_addr) {
+      anchor.putIfChanged(rec_addr);
+      addr = ring_addr;
+      anchor.write(addr,0xff);
+    }
+
+    // free byte after the new record, then length, data, checksum, marker
+    if (addr + size < end_addr)
+      anchor.clear(addr + size);
+    for (int i = 0; i < len_size; i++)
+      anchor.write(addr + 1 + i,(len >> (8 * i)) & 0xff);
+    Writer writer(anchor,addr + head_size);
+    encode(data,writer);
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      anchor.write(writer.addr + i,(writer.chk.sum >> (8 * i)) & 0xff);
+    anchor.write(addr,MARK);
+    anchor.commit();
+
+    rec_addr = addr;
+    rec_len = len;
+
+  }
+
+
+  // write data to EEPROM only if it differs from the current saved data
+  int putIfChanged(const T &data) {
+
+    Counter counter;
+    encode(data,counter);
+    if (rec_addr && counter.len == rec_len) {
+      Comparer comparer(anchor,rec_addr + head_size);
+      encode(data,comparer);
+      if (comparer.equal)
+        return 0;
+    }
+    put(data);
+    return 1;
+
+  }
+
+
+  // size in bytes of the newest record, 0 if none
+  int recordSize(void) {
+
+    return rec_addr ? recordSize(rec_len) : 0;
+
+  }
+
+
+  // size in bytes of a record with len bytes of encoded data
+  static addr_t recordSize(addr_t len) {
+
+    return head_size + len + EEWLChecksum::size;
+
+  }
+
+
+  // true if a whole record starts at addr, len is its encoded data length
+  bool isRecord(addr_t addr, addr_t &len) {
+
+    if (addr < ring_addr || addr + head_size > end_addr
+      || anchor.read(addr) != MARK)
+      return false;
+    len = 0;
+    for (int i = 0; i < len_size; i++)
+      len |= (addr_t) anchor.read(addr + 1 + i) << (8 * i);
+    return len <= data_max && addr + recordSize(len) <= end_addr;
+
+  }
+
+
+  // true if the checksum of record at addr is right. Always true with no
+  // checksum.
+  bool verify(addr_t addr, addr_t len) {
+
+    if (!EEWLChecksum::size)
+      return true;
+    EEWLChecksum chk;
+    addr_t chk_addr = addr + head_size + len;
+    for (addr_t data_addr = addr + head_size; data_addr < chk_addr;
+      data_addr++)
+      chk.add(anchor.read(data_addr));
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      if (anchor.read(chk_addr + i) != ((chk.sum >> (8 * i)) & 0xff))
+        return false;
+    return true;
+
+  }
+
+
+  // byte i of data XORed with defaults
+  uint8_t byteAt(const T &data, int i) {
+
+    uint8_t val = ((const uint8_t *) &data)[i];
+    return defaults ? val ^ ((const uint8_t *) defaults)[i] : val;
+
+  }
+
+
+  // encode data into a sequence of runs, each byte goes to out
+  template <class O> void encode(const T &data, O &out) {
+
+    int size = sizeof(T);
+    for (int i = 0, n; i < size; i += n) {
+
+      // zero run
+      if (!byteAt(data,i)) {
+        for (n = 1; n < 128 && i + n < size && !byteAt(data,i + n); n++);
+        out(0x7f + n);
+        continue;
+      }
+
+      // literal run, single zeros kept, ending before two zeros in a row
+      for (n = 1; n < 128 && i + n < size && (byteAt(data,i + n)
+        || (i + n + 1 < size && byteAt(data,i + n + 1))); n++);
+      out(n - 1);
+      for (int k = 0; k < n; k++)
+        out(byteAt(data,i + k));
+    }
+
+  }
+
+
+  // decode len bytes of runs at addr into data. Returns 0 if runs are not
+  // valid.
+  int decode(addr_t addr, addr_t len, T &data) {
+
+    uint8_t *ptr = (uint8_t *) &data;
+    const uint8_t *def = (const uint8_t *) defaults;
+    int size = sizeof(T);
+    int i = 0;
+    for (addr_t end = addr + len; addr < end;) {
+      int c = anchor.read(addr++);
+      int n = c & 0x80 ? c - 0x7f : c + 1;
+      if (i + n > size || (!(c & 0x80) && addr + n > end))
+        return 0;
+      for (; n; n--, i++)
+        ptr[i] = (c & 0x80 ? 0 : anchor.read(addr++)) ^ (def ? def[i] : 0);
+    }
+    return i == size;
+
+  }
+
+
+  // encode outputs: length count, EEPROM write, EEPROM compare
+  struct Counter {
+
+    addr_t len = 0;
+
+    void operator()(uint8_t val) { (void)val; len++; }
+
+  };
+
+
+  struct Writer {
+
+    EEWLBase<B> &eewl;
+    addr_t addr;
+    EEWLChecksum chk;
+
+    Writer(EEWLBase<B> &eewl_, addr_t addr_): eewl(eewl_), addr(addr_) {}
+
+    void operator()(uint8_t val) {
+      eewl.write(addr++,val);
+      chk.add(val);
+    }
+
+  };
+
+
+  struct Comparer {
+
+    EEWLBase<B> &eewl;
+    addr_t addr;
+    bool equal = true;
+
+    Comparer(EEWLBase<B> &eewl_, addr_t addr_): eewl(eewl_), addr(addr_) {}
+
+    void operator()(uint8_t val) {
+      equal = equal && eewl.read(addr++) == val;
+    }
+
+  };
+
+};
+
+#endif
+
+/**** end ****/
@@ -0,0 +1,135 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL pool, automatic layout of multiple EEWL objects
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL pool holds a list of EEWL objects, one for each record type.
+  The circular buffers are packed back to back from the pool start
+  address, their addresses are computed at compile time. The pool
+  initializer inits the EEPROM emulation once with the exact size of
+  all buffers and inits all the EEWL objects in one pass.
+
+.usage
+  EEWLPool<0x10,
+    EEWLRecord<systemParameters_t,10>,
+    EEWLRecord<unsigned long,40> > pool;
+  ...
+  pool.begin();
+  pool.at<1>().get(powerCycles);
+
+.- */
+
+#ifndef EEWL_POOL_H
+#define EEWL_POOL_H
+
+#include "eewl.h"
+
+
+/**** classes ****/
+
+// pool record: data type and circular buffer length
+template <typename T, int BLK_NUM> struct EEWLRecord {
+
+  typedef T type;
+  static const int blk_num = BLK_NUM;
+  static const int size = EEWL::bufferSize<T>(BLK_NUM);
+
+};
+
+
+template <int START_ADDR, typename... R> struct EEWLPool;
+
+
+// record I lookup, walking down the pool records
+template <int I, typename P> struct EEWLPoolAt {
+
+  static EEWL &at(P &pool) {
+    return EEWLPoolAt<I - 1,typename P::next>::at(pool);
+  }
+
+};
+
+template <typename P> struct EEWLPoolAt<0,P> {
+
+  static EEWL &at(P &pool) { return pool.eewl; }
+
+};
+
+
+// empty pool: end of records list
+template <int START_ADDR> struct EEWLPool<START_ADDR> {
+
+  static const int start_addr = START_ADDR;
+  static const int end_addr = START_ADDR;
+  static const int size = 0;
+
+  void beginAll(void) {}
+
+};
+
+
+// pool of one or more records: first record at START_ADDR, the others
+// are packed just after it.
+template <int START_ADDR, typename R, typename... Rs>
+struct EEWLPool<START_ADDR,R,Rs...>: EEWLPool<START_ADDR + R::size,Rs...> {
+
+  typedef EEWLPool<START_ADDR + R::size,Rs...> next;
+
+  static const int start_addr = START_ADDR;
+  static const int end_addr = next::end_addr;
+  static const int size = end_addr - start_addr;
+
+  #if defined(ESP8266) || defined(TARGET_RP2040)
+  static_assert(end_addr <= 4096,
+    "EEWL pool does not fit into the EEPROM emulation flash sector");
+  #endif
+
+  EEWL eewl;
+
+
+  // class constructor
+  EEWLPool(void): eewl(EEWLType<typename R::type>(),R::blk_num,START_ADDR) {
+
+    static_assert(START_ADDR != 0, "EEWL pool start address 0 not allowed");
+
+  }
+
+
+  // init all EEWL objects of the pool, committing their recovery writes
+  // once.
+  void begin(void) {
+
+    EEWL::Batch batch;
+    beginAll();
+
+  }
+
+
+  // init this pool EEWL object and the following ones
+  void beginAll(void) {
+
+    eewl.begin();
+    next::beginAll();
+
+  }
+
+
+  // return EEWL object of record I
+  template <int I> EEWL &at(void) {
+
+    return EEWLPoolAt<I,EEWLPool>::at(*this);
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
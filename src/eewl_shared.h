@@ -0,0 +1,289 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL shared, EEWL object shared by concurrent tasks
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL shared object allows tasks running on different cores (ESP32
+  FreeRTOS tasks, RP2040 cores) to get and put the same data concurrently.
+
+  Readers are lock free, by a sequence lock: a sequence counter is odd
+  while the writer changes the EEPROM emulation RAM buffer, a reader
+  copies data and retries if the counter was odd or changed meanwhile.
+  The writer changes the RAM buffer without commit, then commits out of
+  the sequence lock, so a reader never waits for a flash commit.
+
+  Writers are serialized by a one slot queue: put copies data into the
+  pending slot and, if no writer is running, becomes the writer, writing
+  pending data until the slot is empty. A put done while a writer is
+  running only replaces the pending data, so superseded updates are
+  coalesced and that put returns at once. All EEWL shared objects write
+  and commit under a common writer mutex, since the EEPROM library is not
+  thread safe.
+
+.usage
+  EEWLShared<Parameters> params(10,0x10);
+  ...
+  params.begin();                   // in setup, before starting tasks
+  ...
+  params.get(parameters);           // any task, lock free
+  params.put(parameters);           // any task
+
+.warning
+  Constructors and begin must run before the tasks sharing the objects
+  are started. Other EEWL objects must not be written concurrently. While
+  flash is written, ESP32 disables the flash cache, so tasks running code
+  from flash stall anyway.
+
+.- */
+
+#ifndef EEWL_SHARED_H
+#define EEWL_SHARED_H
+
+#include "eewl.h"
+#include <atomic>
+
+#if defined(ESP32) && !defined(EEWL_RAM)
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/semphr.h>
+#elif defined(TARGET_RP2040) && !defined(EEWL_RAM)
+  #include <pico/critical_section.h>
+  #include <pico/mutex.h>
+#elif defined(EEWL_RAM)
+  #include <mutex>
+#else
+  #error ERROR: EEWL shared requires ESP32 or RP2040
+#endif
+
+
+/**** locks ****/
+
+#if defined(ESP32) && !defined(EEWL_RAM)
+
+// short critical section, a spin lock between cores
+struct EEWLSpinLock {
+
+  portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+  void lock(void) { portENTER_CRITICAL(&mux); }
+
+  void unlock(void) { portEXIT_CRITICAL(&mux); }
+
+};
+
+
+// writer mutex, blocking. Created by the first begin.
+template <int N = 0> struct EEWLWriterLock {
+
+  static SemaphoreHandle_t mutex;
+
+  static void init(void) {
+    if (!mutex)
+      mutex = xSemaphoreCreateMutex();
+  }
+
+  static void lock(void) { xSemaphoreTake(mutex,portMAX_DELAY); }
+
+  static void unlock(void) { xSemaphoreGive(mutex); }
+
+};
+
+template <int N> SemaphoreHandle_t EEWLWriterLock<N>::mutex = 0;
+
+#elif defined(TARGET_RP2040) && !defined(EEWL_RAM)
+
+// short critical section, a hardware spin lock between cores
+struct EEWLSpinLock {
+
+  critical_section_t cs;
+
+  EEWLSpinLock(void) { critical_section_init(&cs); }
+
+  void lock(void) { critical_section_enter_blocking(&cs); }
+
+  void unlock(void) { critical_section_exit(&cs); }
+
+};
+
+
+// writer mutex, blocking. Initialized by the first begin.
+template <int N = 0> struct EEWLWriterLock {
+
+  static mutex_t mutex;
+  static bool ready;
+
+  static void init(void) {
+    if (!ready) {
+      mutex_init(&mutex);
+      ready = true;
+    }
+  }
+
+  static void lock(void) { mutex_enter_blocking(&mutex); }
+
+  static void unlock(void) { mutex_exit(&mutex); }
+
+};
+
+template <int N> mutex_t EEWLWriterLock<N>::mutex;
+template <int N> bool EEWLWriterLock<N>::ready = false;
+
+#else
+
+// host threads, for testing purposes
+struct EEWLSpinLock {
+
+  std::mutex mux;
+
+  void lock(void) { mux.lock(); }
+
+  void unlock(void) { mux.unlock(); }
+
+};
+
+
+template <int N = 0> struct EEWLWriterLock {
+
+  static std::mutex mutex;
+
+  static void init(void) {}
+
+  static void lock(void) { mutex.lock(); }
+
+  static void unlock(void) { mutex.unlock(); }
+
+};
+
+template <int N> std::mutex EEWLWriterLock<N>::mutex;
+
+#endif
+
+
+/**** class ****/
+
+template <typename T, class B = EEWLDefaultBackend> struct EEWLShared {
+
+  typedef typename B::addr_t addr_t;
+
+  // control vars
+  EEWLBase<B> eewl;
+  std::atomic<uint32_t> seq;
+  EEWLSpinLock slot_lock;
+  T pending;
+  bool has_pending;
+  bool writing;
+
+
+  // member functions
+
+  // class constructor
+  EEWLShared(addr_t blk_num_, addr_t start_addr_):
+    eewl(EEWLType<T>(),blk_num_,start_addr_), seq(0), has_pending(false),
+    writing(false) {}
+
+
+  // class initializer, to be called before tasks sharing the object start
+  void begin(void) {
+
+    EEWLWriterLock<>::init();
+    eewl.begin();
+
+  }
+
+
+  // read data, lock free: retry while the writer changes it
+  int get(T &data) {
+
+    uint32_t s;
+    int found;
+    do {
+      s = seq.load(std::memory_order_acquire);
+      if (s & 1)
+        continue;
+      addr_t blk_addr = eewl.blk_addr;
+      found = blk_addr != 0;
+      if (found)
+        eewl.readBlock(blk_addr + 1,(uint8_t *) &data,sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((s & 1) || seq.load(std::memory_order_relaxed) != s);
+    return found;
+
+  }
+
+
+  // write data. If a writer is running, data replaces its pending data
+  // and the call returns at once, else the caller becomes the writer.
+  void put(const T &data) {
+
+    if (store(data))
+      writePending();
+
+  }
+
+
+  // store data into the pending slot. Returns true if no writer is
+  // running, so the caller must start one.
+  bool store(const T &data) {
+
+    slot_lock.lock();
+    pending = data;
+    has_pending = true;
+    bool running = writing;
+    writing = true;
+    slot_lock.unlock();
+    return !running;
+
+  }
+
+
+  // write pending data until the slot is empty
+  void writePending(void) {
+
+    T data;
+    while (true) {
+      slot_lock.lock();
+      if (!has_pending) {
+        writing = false;
+        slot_lock.unlock();
+        return;
+      }
+      data = pending;
+      has_pending = false;
+      slot_lock.unlock();
+
+      // change the RAM buffer within the sequence lock, commit out of it
+      EEWLWriterLock<>::lock();
+      {
+        typename EEWLBase<B>::Batch batch;
+        seq.fetch_add(1,std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        eewl.put(data);
+        seq.fetch_add(1,std::memory_order_release);
+      }
+      EEWLWriterLock<>::unlock();
+    }
+
+  }
+
+
+  // true while a writer is running or data is pending
+  bool busy(void) {
+
+    slot_lock.lock();
+    bool running = writing;
+    slot_lock.unlock();
+    return running;
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
@@ -0,0 +1,339 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL versioned, circular buffer with a layout header
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL versioned object is an EEWL circular buffer preceded by a layout
+  header recording the layout version, the data size and the number of
+  blocks. The header is itself saved into a 2 blocks EEWL buffer at the
+  start address, so its update is power off safe. When begin finds a
+  header different from the current one, for example after a firmware
+  update changing data type or buffer length, the current data of the old
+  layout is moved into the new one, instead of being lost.
+
+.migration
+  The old current data is located, by the old layout begin, and its block
+  is recorded into the header, flagged as pending: from now on it is never
+  written and begin reads it directly. The common prefix of old and new
+  data is copied into RAM, then the optional conversion hook may fix it,
+  reading the old block if needed. The new data is written into the first
+  block of the new layout not overlapping the old current block, with the
+  markers of the other new blocks set free, but the ones inside the old
+  current block. The header is then updated to the new layout, with the
+  new data block flagged as pending. Finally the markers left are set free
+  and the pending flag is cleared. In sequence mode, the new data is moved
+  to the first block before, recording it into the header. A power off at
+  any step is completed by the next begin. If every new block overlaps the
+  old current block, the one with the smallest overlap is used: then, a
+  power off before the header update may corrupt the overlapped old data.
+
+.usage
+  void convert(Parameters &data, EEWLBase<> &old, uint8_t version) {
+    if (version < 2)
+      data.newField = 0;
+  }
+  EEWLVersioned<Parameters,2> params(10,0x10,convert);
+  ...
+  params.begin();
+
+.warning
+  Backend, compile options and start address must be the same for the
+  old and the new layout. On flash emulated EEPROM, the emulation is sized
+  at the first begin: an old layout ending after it is not migrated, but
+  formatted. To keep data when the new layout is smaller, give the old
+  layout end address as max_end_addr to the constructor.
+
+.- */
+
+#ifndef EEWL_VERSIONED_H
+#define EEWL_VERSIONED_H
+
+#include "eewl.h"
+
+
+// layout header
+struct EEWLLayoutInfo {
+
+  static const uint8_t MAGIC = 0xe7;
+
+  uint8_t magic;
+  uint8_t version;
+  uint8_t pending;
+  uint16_t data_size;
+  uint16_t blk_num;
+  uint16_t head;
+
+};
+
+
+/**** class ****/
+
+template <typename T, uint8_t VERSION = 0, class B = EEWLDefaultBackend>
+struct EEWLVersioned {
+
+  typedef typename B::addr_t addr_t;
+  typedef void (*Convert)(T &data, EEWLBase<B> &old, uint8_t old_version);
+
+  // control vars
+  EEWLBase<B> info;
+  EEWLBase<B> eewl;
+  Convert convert;
+
+
+  // member functions
+
+  // class constructor: the data buffer follows the layout header.
+  // Storage up to max_end_addr, if larger, is reserved too, so an old
+  // larger layout can be migrated.
+  EEWLVersioned(addr_t blk_num_, addr_t start_addr_, Convert convert_ = 0,
+    addr_t max_end_addr = 0):
+    info(EEWLType<EEWLLayoutInfo>(),2,start_addr_),
+    eewl(EEWLType<T>(),blk_num_,info.end_addr), convert(convert_) {
+
+    if (max_end_addr > eewl.end_addr)
+      eewl.reserve(max_end_addr);
+
+  }
+
+
+  // class initializer: check the layout header, migrate data of a
+  // different layout, then locate current data.
+  void begin(void) {
+
+    info.begin();
+
+    // no header: new buffer
+    EEWLLayoutInfo saved;
+    if (!info.get(saved) || saved.magic != EEWLLayoutInfo::MAGIC) {
+      eewl.fastFormat();
+      saved = layout(0,0);
+      info.put(saved);
+    }
+
+    if (saved.version != VERSION || saved.data_size != sizeof(T)
+      || saved.blk_num != eewl.blk_num)
+      saved = migrate(saved);
+
+    // complete a migration
+    if (saved.pending)
+      complete(saved.head);
+
+    eewl.begin();
+
+  }
+
+
+  // format the data circular buffer, data is logically cleared.
+  void fastFormat(void) {
+
+    eewl.fastFormat();
+
+  }
+
+
+  // read data from EEPROM
+  int get(T &data) {
+
+    return eewl.get(data);
+
+  }
+
+
+  // write data to EEPROM
+  void put(T &data) {
+
+    eewl.put(data);
+
+  }
+
+
+  // write data to EEPROM only if it differs from the current saved data
+  int putIfChanged(T &data) {
+
+    return eewl.putIfChanged(data);
+
+  }
+
+
+  // current layout header
+  EEWLLayoutInfo layout(uint8_t pending, uint16_t head) {
+
+    EEWLLayoutInfo cur;
+    cur.magic = EEWLLayoutInfo::MAGIC;
+    cur.version = VERSION;
+    cur.pending = pending;
+    cur.data_size = sizeof(T);
+    cur.blk_num = eewl.blk_num;
+    cur.head = head;
+    return cur;
+
+  }
+
+
+  // move the current data of the old layout into the new one. Returns the
+  // updated header.
+  EEWLLayoutInfo migrate(EEWLLayoutInfo saved) {
+
+    // set the buffer to the old layout. An old layout beyond the inited
+    // storage has no data.
+    addr_t blk_num_ = eewl.blk_num;
+    addr_t start_addr_ = eewl.start_addr;
+    eewl.setGeometry(saved.data_size,saved.blk_num,start_addr_);
+    bool old_data = holds((B *) 0,eewl.end_addr);
+    if (old_data)
+      eewl.reserve(eewl.end_addr);
+
+    // locate the old current data, unless a migration already started,
+    // then record it into the header.
+    if (old_data && !saved.pending) {
+      eewl.begin();
+      old_data = eewl.blk_addr != 0;
+    }
+    if (!old_data) {
+
+      // no old data: format the new layout only
+      eewl.template setGeometry<T>(blk_num_,start_addr_);
+      eewl.fastFormat();
+      saved = layout(0,0);
+      info.put(saved);
+      return saved;
+    }
+    if (!saved.pending) {
+      saved.pending = 1;
+      saved.head = (eewl.blk_addr - start_addr_) / eewl.blk_size;
+      info.put(saved);
+    }
+
+    // read and convert old data
+    T data = T();
+    addr_t old_addr = blockAddr(saved.head);
+    addr_t old_end = old_addr + eewl.blk_size;
+    eewl.blk_addr = old_addr;
+    eewl.readBlock(old_addr + 1,(uint8_t *) &data,
+      saved.data_size < sizeof(T) ? saved.data_size : sizeof(T));
+    if (convert)
+      convert(data,eewl,saved.version);
+    eewl.template setGeometry<T>(blk_num_,start_addr_);
+
+    // new block holding data: the first one not overlapping the old
+    // current block or, if all of them overlap it, the one with the
+    // smallest overlap.
+    addr_t head = 0;
+    for (addr_t i = 1; i < eewl.blk_num && overlap(head,old_addr,old_end);
+      i++)
+      if (overlap(i,old_addr,old_end) < overlap(head,old_addr,old_end))
+        head = i;
+    addr_t addr = blockAddr(head);
+
+    // write new data block, set free the other markers out of the old
+    // current block.
+    clearMarkers(head,old_addr,old_end);
+    EEWLChecksum chk;
+    chk.add((const uint8_t *) &data,sizeof(T));
+    uint8_t chk_bytes[EEWLChecksum::size + 1] = {0};
+    for (int i = 0; i < EEWLChecksum::size; i++)
+      chk_bytes[i] = (chk.sum >> (8 * i)) & 0xff;
+    eewl.writeBlock(addr + 1,(const uint8_t *) &data,sizeof(T));
+    eewl.writeBlock(addr + 1 + sizeof(T),chk_bytes,EEWLChecksum::size);
+    eewl.write(addr,0xfe);
+    eewl.commit();
+
+    // switch to the new layout
+    saved = layout(1,head);
+    info.put(saved);
+    return saved;
+
+  }
+
+
+  // complete a migration: set free the markers of all blocks but the new
+  // data one and clear the pending flag. In sequence mode, data is moved
+  // to the first block before, as the sequence layout requires.
+  void complete(addr_t head) {
+
+    #ifdef EEWL_FAST_BEGIN
+    if (head) {
+      addr_t addr = blockAddr(head);
+      for (addr_t n = 1; n < eewl.blk_size; n++)
+        eewl.write(eewl.start_addr + n,eewl.read(addr + n));
+      eewl.write(eewl.start_addr,eewl.read(addr));
+      eewl.commit();
+      head = 0;
+      EEWLLayoutInfo cur = layout(1,head);
+      info.put(cur);
+    }
+    #endif
+
+    clearMarkers(head,0,0);
+    EEWLLayoutInfo cur = layout(0,0);
+    info.put(cur);
+
+  }
+
+
+  // set free the markers of all blocks but head, skipping the ones within
+  // skip_addr and skip_end.
+  void clearMarkers(addr_t head, addr_t skip_addr, addr_t skip_end) {
+
+    for (addr_t i = 0; i < eewl.blk_num; i++) {
+      addr_t addr = blockAddr(i);
+      if (i != head && (addr < skip_addr || addr >= skip_end))
+        eewl.write(addr,0xff);
+    }
+    eewl.commit();
+
+  }
+
+
+  // true if the storage holds addresses up to end_addr. The flash EEPROM
+  // emulation holds the addresses reserved before its first begin only.
+  template <class S> static bool holds(S *, addr_t end_addr) {
+
+    (void) end_addr;
+    return true;
+
+  }
+
+
+  #ifdef EEWL_FLASH_EMU
+  static bool holds(EEWLFlashEeprom *, addr_t end_addr) {
+
+    return EEPROM.length() >= end_addr;
+
+  }
+  #endif
+
+
+  // number of bytes of the block at given index within addr and end
+  addr_t overlap(addr_t index, addr_t addr, addr_t end) {
+
+    addr_t blk_start = blockAddr(index);
+    addr_t blk_end = blk_start + eewl.blk_size;
+    if (blk_start < addr)
+      blk_start = addr;
+    if (blk_end > end)
+      blk_end = end;
+    return blk_start < blk_end ? blk_end - blk_start : 0;
+
+  }
+
+
+  // address of the block at given index
+  addr_t blockAddr(addr_t index) {
+
+    return eewl.start_addr + index * eewl.blk_size;
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
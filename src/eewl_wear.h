@@ -0,0 +1,171 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL wear, circular buffer with a persistent wear estimator
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL wear object is an EEWL circular buffer plus a counter of the
+  passes over it, saved into a small secondary EEWL buffer just after the
+  data buffer, so the counter itself is wear leveled. A pass is counted at
+  each put into the first block. In both buffer layouts, a pass writes the
+  marker of each block twice (set and cleared) and its data and checksum
+  once, so the most worn cells have about twice as many write cycles as
+  the passes. From this, the estimated cell write cycles and the remaining
+  life, in cycles and in puts, are computed for a given cell endurance.
+  The counter buffer wears by one put per pass, so with the default 4
+  blocks its most worn cells have one quarter of the write cycles of the
+  data buffer ones.
+
+.power_off_safety
+  The counter is saved after the data put, a power off in between loses
+  one pass of the count only.
+
+.usage
+  EEWLWear<Parameters> params(10,0x10);
+  ...
+  params.begin();
+  params.put(parameters);
+  if (params.remainingPuts() < 1000)
+    maintenanceAlert();
+
+.warning
+  On flash emulated EEPROM each commit rewrites the whole emulation flash
+  sector, so flash wear depends on the number of commits, not on the cell
+  write cycles estimated here.
+
+.- */
+
+#ifndef EEWL_WEAR_H
+#define EEWL_WEAR_H
+
+#include "eewl.h"
+
+// default cell endurance, in write cycles
+#ifndef EEWL_ENDURANCE
+  #define EEWL_ENDURANCE 100000
+#endif
+
+
+/**** class ****/
+
+template <typename T, class B = EEWLDefaultBackend> struct EEWLWear {
+
+  typedef typename B::addr_t addr_t;
+
+  // control vars
+  EEWLBase<B> eewl;
+  EEWLBase<B> passes;
+  uint32_t pass_count;
+
+
+  // member functions
+
+  // class constructor: the pass counter buffer of pass_blk_num blocks
+  // follows the data buffer.
+  EEWLWear(addr_t blk_num_, addr_t start_addr_, addr_t pass_blk_num_ = 4):
+    eewl(EEWLType<T>(),blk_num_,start_addr_),
+    passes(EEWLType<uint32_t>(),pass_blk_num_,eewl.end_addr),
+    pass_count(0) {}
+
+
+  // class initializer: locate current data and load the pass counter
+  void begin(void) {
+
+    eewl.begin();
+    passes.begin();
+    if (!passes.get(pass_count))
+      pass_count = 0;
+
+  }
+
+
+  // format the data circular buffer, data is logically cleared. The pass
+  // counter is kept, since cell wear is not cleared.
+  void fastFormat(void) {
+
+    eewl.fastFormat();
+
+  }
+
+
+  // read data from EEPROM
+  int get(T &data) {
+
+    return eewl.get(data);
+
+  }
+
+
+  // write data to EEPROM
+  void put(T &data) {
+
+    eewl.put(data);
+    countPass();
+
+  }
+
+
+  // write data to EEPROM only if it differs from the current saved data
+  int putIfChanged(T &data) {
+
+    if (!eewl.putIfChanged(data))
+      return 0;
+    countPass();
+    return 1;
+
+  }
+
+
+  // count a pass when the last put went into the first block
+  void countPass(void) {
+
+    if (eewl.blk_addr == eewl.start_addr) {
+      pass_count++;
+      passes.put(pass_count);
+    }
+
+  }
+
+
+  // number of passes over the data buffer
+  uint32_t passCount(void) {
+
+    return pass_count;
+
+  }
+
+
+  // estimated write cycles of the most worn cells, the block markers
+  uint32_t cycles(void) {
+
+    return 2 * pass_count;
+
+  }
+
+
+  // estimated write cycles left before the given cell endurance
+  uint32_t remainingCycles(uint32_t endurance = EEWL_ENDURANCE) {
+
+    return cycles() < endurance ? endurance - cycles() : 0;
+
+  }
+
+
+  // estimated puts left before the given cell endurance
+  uint32_t remainingPuts(uint32_t endurance = EEWL_ENDURANCE) {
+
+    return remainingCycles(endurance) / 2 * eewl.blk_num;
+
+  }
+
+};
+
+#endif
+
+/**** end ****/
@@ -0,0 +1,111 @@
+/* .+
+
+.context    : EEWL EEPROM wear level library
+.title      : EEWL writer, put step by step within a time budget
+.kind       : c++ source
+.author     : Fabrizio Pollastri <mxgbot@gmail.com>
+.site       : Torino - Italy
+.creation   : 14-Oct-2026
+.copyright  : (c) 2026 Fabrizio Pollastri
+.license    : GNU Lesser General Public License
+
+.description
+  An EEWL writer does a put of an EEWL object in several steps, each one
+  writing as many bytes as a given time budget allows. It allows to split
+  a long write along several iterations of a control loop, without using
+  interrupts. The write order is the same of put: data, checksum, data
+  marker and free of the old block, so power off safety is the same of
+  put. The current data of the EEWL object is switched to the new block,
+  and EEPROM is committed, at the end of the last step.
+
+.usage
+  EEWLWriter<Parameters> writer(sysParms);
+  ...
+  writer.start(parameters);
+  ...
+  void loop() {
+    writer.step(200);   // spend at most about 200 us writing
+    ...
+  }
+
+.- */
+
+#ifndef EEWL_WRITER_H
+#define EEWL_WRITER_H
+
+#include "eewl.h"
+
+
+/**** class ****/
+
+template <typename T, class E = EEWL> struct EEWLWriter {
+
+  // control vars
+  E &eewl;
+  T data;
+  typename E::PutState state;
+  bool pending;
+
+
+  // member functions
+
+  // class constructor
+  EEWLWriter(E &eewl_): eewl(eewl_), pending(false) {}
+
+
+  // start a put of data. Data is copied, so it can be changed just after
+  // the call. A put still pending is completed first.
+  void start(const T &data_) {
+
+    flush();
+    data = data_;
+    eewl.putStart(state,(const uint8_t *) &data,sizeof(T));
+    pending = true;
+
+  }
+
+
+  // write at least one byte and go on until budget_us microseconds are
+  // elapsed. Returns true when the put is complete.
+  bool step(unsigned long budget_us) {
+
+    if (!pending)
+      return true;
+
+    unsigned long start_us = micros();
+    typename E::addr_t addr;
+    uint8_t val;
+    do {
+      if (!eewl.putStep(state,addr,val)) {
+        eewl.putEnd(state);
+        pending = false;
+        return true;
+      }
+      eewl.write(addr,val);
+    } while (micros() - start_us < budget_us);
+
+    return false;
+
+  }
+
+
+  // complete the pending put, if any
+  void flush(void) {
+
+    while (!step(0xffffffff));
+
+  }
+
+
+  // true while a put is in progress
+  bool busy(void) {
+
+    return pending;
+
+  }
+
+};
+
+#endif
+
+/**** end ****/